@@ -0,0 +1,729 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * KUnit tests for the JD9365 panel sequences. Built into the driver with
+ * CONFIG_DRM_PANEL_JADARD_JD9365TN_KUNIT_TEST so they get at its internals.
+ *
+ * The panel is bound to a fake DSI host that records every transfer, and
+ * jadard_sleep() runs on a virtual clock. A cold prepare then takes no time
+ * and its packets and delays can be checked one by one.
+ */
+
+#include <kunit/device.h>
+#include <kunit/test.h>
+
+#include <linux/pm_domain.h>
+
+#define JADARD_TEST_MAX_EVENTS		128
+
+/* Long enough for the rails to stay up for the whole test */
+#define JADARD_TEST_AUTOSUSPEND_MS	60000
+
+/* What a cold prepare of the Shenzen panel costs, bump with the sequence */
+#define JADARD_TEST_COLD_PACKETS	46
+#define JADARD_TEST_COLD_BYTES		663
+#define JADARD_TEST_COLD_DELAY_US	305000
+
+/*
+ * The manufacturer's init code as sent on the wire, explicit page switches
+ * included. Kept apart from the driver's table on purpose, so any edit to
+ * that table has to be made here as well.
+ */
+static const u8 jadard_test_manufacturer_init[] = {
+	JADARD_DCS(0xDF, 0x90, 0x69, 0xF9),
+	JADARD_DCS(0xDE, 0x00),
+	JADARD_DCS(0xCC, 0x31),
+	JADARD_DCS(0xB2, 0x01, 0x23, 0x60, 0x88, 0x24, 0x5A, 0x07),
+	JADARD_DCS(0xBB, 0x02, 0x1A, 0x33, 0x5A, 0x3C, 0x44, 0x44),
+	JADARD_DCS(0xBD, 0x00, 0xD0, 0x00),
+	JADARD_DCS(0xBF, 0x50, 0x3C, 0x33, 0xC3),
+	JADARD_DCS(0xC0, 0x01, 0xAD, 0x01, 0xAD),
+	JADARD_DCS(0xCB, 0x7F, 0x7A, 0x75, 0x6C, 0x63, 0x64, 0x57, 0x5C, 0x46,
+		   0x5C, 0x57, 0x53, 0x6B, 0x54, 0x56, 0x44, 0x3E, 0x2F, 0x1D,
+		   0x14, 0x10, 0x7F, 0x7A, 0x75, 0x6C, 0x63, 0x64, 0x57, 0x5C,
+		   0x46, 0x5C, 0x57, 0x53, 0x6B, 0x54, 0x56, 0x44, 0x3E, 0x2F,
+		   0x1D, 0x14, 0x10, 0x00),
+	JADARD_DCS(0xC3, 0x3B, 0x01, 0x00, 0x03, 0x08, 0x08, 0x4C, 0x05, 0x4E,
+		   0x05, 0x4E, 0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A,
+		   0x06, 0x09, 0x06, 0x09, 0x06, 0x09),
+	JADARD_DCS(0xC4, 0x01, 0x00, 0x03, 0x08, 0x08, 0x4C, 0x05, 0x4E, 0x05,
+		   0x4E, 0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A, 0x06,
+		   0x09, 0x06, 0x09, 0x06, 0x09),
+	JADARD_DCS(0xC5, 0x03, 0x03, 0x08, 0x08, 0x4C, 0x05, 0x4E, 0x05, 0x4E,
+		   0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A, 0x06, 0x09,
+		   0x06, 0x09, 0x06, 0x09),
+	JADARD_DCS(0xC6, 0x00, 0x59, 0x00, 0xB4, 0x00, 0x13, 0x28, 0x82, 0x00,
+		   0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x01, 0x00, 0x00, 0x01),
+	JADARD_DCS(0xC8, 0x2B, 0x1C, 0x78),
+	JADARD_DCS(0xCD, 0x06, 0x02),
+	JADARD_DCS(0xCE, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
+		   0x0C, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xCF, 0x00, 0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+		   0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+		   0xFF, 0x3F),
+	JADARD_DCS(0xD0, 0x00, 0x1F, 0x1F, 0x11, 0x24, 0x24, 0x0B, 0x09, 0x07,
+		   0x05, 0x01, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xD1, 0x00, 0x1F, 0x1F, 0x10, 0x24, 0x24, 0x0A, 0x08, 0x06,
+		   0x04, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xD2, 0x00, 0x1F, 0x1F, 0x00, 0x24, 0x24, 0x08, 0x0A, 0x04,
+		   0x06, 0x10, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F),
+	JADARD_DCS(0xD3, 0x00, 0x1F, 0x1F, 0x00, 0x24, 0x24, 0x09, 0x0B, 0x05,
+		   0x07, 0x11, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F),
+	JADARD_DCS(0xD4, 0x00, 0x20, 0x0C, 0x00, 0x0A, 0x00, 0x0C, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x03,
+		   0x03, 0x00, 0x81, 0x04, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x80, 0x09, 0x00, 0x0A, 0x06, 0x55, 0x06, 0x0D,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00),
+	JADARD_DCS(0xD5, 0x02, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0xE0, 0x00, 0x00, 0x00, 0x07, 0x32, 0x5A, 0x00, 0x00, 0x05,
+		   0x00, 0x01, 0x00, 0x30, 0x74, 0x00, 0x0E, 0x00, 0x08, 0x00,
+		   0x71, 0x20, 0x04, 0x10, 0x04, 0x06, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x1F, 0xFF,
+		   0x00, 0x00, 0x00, 0x1F, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+		   0xFF, 0xFF, 0x00),
+	JADARD_DCS(0xD7, 0x00, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34,
+		   0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34),
+	JADARD_DCS(0xDE, 0x01),
+	JADARD_DCS(0xB9, 0x00, 0xFF, 0xFF, 0x04),
+	JADARD_DCS(0xC7, 0x1B, 0x14, 0x0E),
+	JADARD_DCS(0xDE, 0x02),
+	JADARD_DCS(0xBB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x68, 0x69),
+	JADARD_DCS(0xBD, 0x1B),
+	JADARD_DCS(0xC1, 0x00, 0x40, 0x00, 0x02, 0x02, 0x02, 0x02, 0x7F, 0x00,
+		   0x00, 0x00, 0x00),
+	JADARD_DCS(0xC3, 0x20, 0xFF),
+	JADARD_DCS(0xC4, 0x00, 0x11, 0x07, 0x00, 0x02),
+	JADARD_DCS(0xC6, 0x49, 0x00),
+	JADARD_DCS(0xE5, 0x00, 0xE6, 0xE5, 0x02, 0x27, 0x42, 0x27, 0x42, 0x09,
+		   0x04, 0x00, 0x40, 0x00, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xE6, 0x10, 0x09, 0xAD, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xEC, 0x07, 0x07, 0x40, 0x00, 0x22, 0x02, 0x00, 0xFF, 0x08,
+		   0x7C, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xDE, 0x03),
+	JADARD_DCS(0xD1, 0x00, 0x00, 0x21, 0xFF, 0x00),
+	JADARD_DCS(0xDE, 0x00),
+	JADARD_DCS(MIPI_DCS_SET_TEAR_ON, MIPI_DSI_DCS_TEAR_MODE_VBLANK),
+	JADARD_DELAY(30),
+};
+
+/* A transfer as the host saw it, or a delay if sleep_us is set */
+struct jadard_test_event {
+	unsigned int sleep_us;
+	u8 type;
+	bool lpm;
+	size_t len;
+	u8 data[U8_MAX];
+};
+
+struct jadard_test_log {
+	struct jadard_test_event events[JADARD_TEST_MAX_EVENTS];
+	unsigned int count;
+};
+
+struct jadard_test {
+	struct mipi_dsi_host host;
+	struct mipi_dsi_device *dsi;
+	struct jadard *jadard;
+	struct jadard_test_log sent;
+	struct jadard_test_log expected;
+	/* Mode the next expected transfer goes out in */
+	bool expect_lpm;
+	unsigned int transfers;
+	size_t bytes;
+	u64 virtual_us;
+	/* Transfer the host fails with -EIO, counting from 1 */
+	unsigned int fail_at;
+	/* Read back for MIPI_DCS_GET_POWER_MODE and the signature register */
+	u8 power_mode;
+	u8 signature;
+};
+
+static struct jadard_test_event *jadard_test_add(struct kunit *test,
+						 struct jadard_test_log *log)
+{
+	struct jadard_test_event *ev;
+
+	KUNIT_ASSERT_LT(test, log->count, JADARD_TEST_MAX_EVENTS);
+
+	ev = &log->events[log->count++];
+	memset(ev, 0, sizeof(*ev));
+
+	return ev;
+}
+
+static ssize_t jadard_test_transfer(struct mipi_dsi_host *host,
+				    const struct mipi_dsi_msg *msg)
+{
+	struct jadard_test *ctx = container_of(host, struct jadard_test, host);
+	struct kunit *test = kunit_get_current_test();
+	const u8 *tx = msg->tx_buf;
+	struct jadard_test_event *ev;
+	u8 *rx = msg->rx_buf;
+
+	ev = jadard_test_add(test, &ctx->sent);
+	ev->type = msg->type;
+	ev->lpm = msg->flags & MIPI_DSI_MSG_USE_LPM;
+	ev->len = msg->tx_len;
+	memcpy(ev->data, tx, min_t(size_t, msg->tx_len, sizeof(ev->data)));
+
+	ctx->transfers++;
+	ctx->bytes += msg->tx_len;
+
+	if (ctx->transfers == ctx->fail_at)
+		return -EIO;
+
+	if (!msg->rx_len)
+		return msg->tx_len;
+
+	memset(rx, 0, msg->rx_len);
+	if (tx[0] == MIPI_DCS_GET_POWER_MODE)
+		rx[0] = ctx->power_mode;
+	else if (tx[0] == ctx->jadard->desc->signature_reg)
+		rx[0] = ctx->signature;
+	else
+		return -EIO;
+
+	return msg->rx_len;
+}
+
+static const struct mipi_dsi_host_ops jadard_test_host_ops = {
+	.transfer = jadard_test_transfer,
+};
+
+static void jadard_test_sleep(struct jadard *jadard, unsigned int us)
+{
+	struct kunit *test = kunit_get_current_test();
+	struct jadard_test *ctx = test->priv;
+
+	jadard_test_add(test, &ctx->sent)->sleep_us = us;
+	ctx->virtual_us += us;
+}
+
+static void jadard_test_reset_log(struct jadard_test *ctx)
+{
+	ctx->sent.count = 0;
+	ctx->expected.count = 0;
+	ctx->transfers = 0;
+	ctx->bytes = 0;
+	ctx->virtual_us = 0;
+	ctx->fail_at = 0;
+}
+
+static void jadard_test_expect_write(struct kunit *test, const u8 *buf,
+				     size_t len)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard_test_event *ev = jadard_test_add(test, &ctx->expected);
+
+	/* Packet types as picked by mipi_dsi_dcs_write_buffer() */
+	if (len == 1)
+		ev->type = MIPI_DSI_DCS_SHORT_WRITE;
+	else if (len == 2)
+		ev->type = MIPI_DSI_DCS_SHORT_WRITE_PARAM;
+	else
+		ev->type = MIPI_DSI_DCS_LONG_WRITE;
+	ev->lpm = ctx->expect_lpm;
+	ev->len = len;
+	memcpy(ev->data, buf, len);
+}
+
+#define jadard_test_expect_dcs(test, cmd, seq...)			\
+	do {								\
+		const u8 d[] = { cmd, ##seq };				\
+									\
+		jadard_test_expect_write(test, d, sizeof(d));		\
+	} while (0)
+
+static void jadard_test_expect_read(struct kunit *test, u8 cmd)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard_test_event *ev = jadard_test_add(test, &ctx->expected);
+
+	ev->type = MIPI_DSI_DCS_READ;
+	ev->lpm = ctx->expect_lpm;
+	ev->len = 1;
+	ev->data[0] = cmd;
+}
+
+/* Zero delays never make it to jadard_sleep() */
+static void jadard_test_expect_sleep(struct kunit *test, unsigned int us)
+{
+	struct jadard_test *ctx = test->priv;
+
+	if (us)
+		jadard_test_add(test, &ctx->expected)->sleep_us = us;
+}
+
+static void jadard_test_expect_page(struct kunit *test, u8 page)
+{
+	struct jadard_test *ctx = test->priv;
+
+	jadard_test_expect_dcs(test, ctx->jadard->desc->chip->switch_page_cmd,
+			       page);
+}
+
+/*
+ * The manufacturer's init code from byte offset @start on, up to
+ * @max_writes writes.
+ */
+static void jadard_test_expect_init(struct kunit *test, size_t start,
+				    unsigned int max_writes)
+{
+	const u8 *init = jadard_test_manufacturer_init;
+	size_t i;
+
+	for (i = start; i < sizeof(jadard_test_manufacturer_init) && max_writes;
+	     i += jadard_entry_len(&init[i])) {
+		if (init[i] == JADARD_OP_DELAY) {
+			jadard_test_expect_sleep(test, init[i + 1] * USEC_PER_MSEC);
+		} else {
+			jadard_test_expect_write(test, &init[i + 2], init[i + 1]);
+			max_writes--;
+		}
+	}
+}
+
+/* Offset of the page switch that write @n, counting from 1, comes after */
+static size_t jadard_test_init_segment(struct kunit *test, unsigned int n)
+{
+	struct jadard_test *ctx = test->priv;
+	const u8 switch_cmd = ctx->jadard->desc->chip->switch_page_cmd;
+	const u8 *init = jadard_test_manufacturer_init;
+	size_t segment = SIZE_MAX;
+	size_t i;
+
+	for (i = 0; i < sizeof(jadard_test_manufacturer_init) && n;
+	     i += jadard_entry_len(&init[i])) {
+		if (init[i] != JADARD_OP_DCS)
+			continue;
+		if (init[i + 2] == switch_cmd)
+			segment = i;
+		n--;
+	}
+	KUNIT_ASSERT_NE(test, segment, SIZE_MAX);
+
+	return segment;
+}
+
+/* Everything up to the init table in a cold prepare */
+static void jadard_test_expect_power_on(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	const struct jadard_timings *t = &ctx->jadard->timings;
+
+	jadard_test_expect_sleep(test, t->vcioo_to_lp11_us);
+	if (ctx->jadard->desc->lp11_before_reset)
+		jadard_test_expect_dcs(test, MIPI_DCS_NOP);
+	jadard_test_expect_sleep(test, t->lp11_to_reset_us);
+	jadard_test_expect_sleep(test, t->reset_low_us);
+	jadard_test_expect_sleep(test, t->reset_pulse_us);
+	jadard_test_expect_sleep(test, t->reset_to_init_us);
+
+	ctx->expect_lpm = !ctx->jadard->desc->init_in_hs_mode;
+}
+
+/* Everything after the init table in a cold prepare */
+static void jadard_test_expect_config(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	const struct drm_display_mode *mode = &ctx->jadard->desc->modes[0];
+	u8 format = jadard_dcs_pixel_format(ctx->dsi->format);
+	u16 x2 = mode->hdisplay - 1;
+	u16 y2 = mode->vdisplay - 1;
+
+	jadard_test_expect_dcs(test, MIPI_DCS_SET_PIXEL_FORMAT,
+			       format << 4 | format);
+
+	ctx->expect_lpm = true;
+	jadard_test_expect_dcs(test, MIPI_DCS_SET_COLUMN_ADDRESS,
+			       0, 0, x2 >> 8, x2 & 0xff);
+	jadard_test_expect_dcs(test, MIPI_DCS_SET_PAGE_ADDRESS,
+			       0, 0, y2 >> 8, y2 & 0xff);
+}
+
+static void jadard_test_expect_wake(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	const struct jadard_timings *t = &ctx->jadard->timings;
+
+	jadard_test_expect_dcs(test, MIPI_DCS_EXIT_SLEEP_MODE);
+	jadard_test_expect_sleep(test, t->sleep_out_us);
+	jadard_test_expect_dcs(test, MIPI_DCS_SET_DISPLAY_ON);
+	jadard_test_expect_sleep(test, t->display_on_us);
+}
+
+static void jadard_test_check_log(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	const struct jadard_test_log *sent = &ctx->sent;
+	const struct jadard_test_log *exp = &ctx->expected;
+	unsigned int i;
+
+	for (i = 0; i < min(sent->count, exp->count); i++) {
+		const struct jadard_test_event *s = &sent->events[i];
+		const struct jadard_test_event *e = &exp->events[i];
+
+		KUNIT_ASSERT_EQ_MSG(test, s->sleep_us, e->sleep_us,
+				    "delay at event %u", i);
+		KUNIT_ASSERT_EQ_MSG(test, s->type, e->type,
+				    "packet type at event %u", i);
+		KUNIT_ASSERT_EQ_MSG(test, s->lpm, e->lpm,
+				    "LP mode at event %u", i);
+		KUNIT_ASSERT_EQ_MSG(test, s->len, e->len,
+				    "length at event %u", i);
+		KUNIT_ASSERT_MEMEQ_MSG(test, s->data, e->data, e->len,
+				       "payload at event %u", i);
+	}
+
+	KUNIT_ASSERT_EQ(test, sent->count, exp->count);
+}
+
+/* Every transfer and delay was accounted, and the whole lot fits the budget */
+static void jadard_test_check_prepare(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	const struct jadard *jadard = ctx->jadard;
+	const struct jadard_link_stats *last = &jadard->last_prepare;
+
+	KUNIT_EXPECT_EQ(test, last->packets, ctx->transfers);
+	KUNIT_EXPECT_EQ(test, last->bytes, ctx->bytes);
+	KUNIT_EXPECT_EQ(test, last->sleep_us, ctx->virtual_us);
+	KUNIT_EXPECT_LE(test, last->sleep_us, jadard->desc->prepare_budget_us);
+}
+
+static void jadard_test_prepare_cold(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	const struct jadard_link_stats *last = &jadard->last_prepare;
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+
+	jadard_test_expect_power_on(test);
+	jadard_test_expect_init(test, 0, UINT_MAX);
+	jadard_test_expect_config(test);
+	jadard_test_expect_wake(test);
+	jadard_test_check_log(test);
+	jadard_test_check_prepare(test);
+
+	KUNIT_EXPECT_EQ(test, last->packets, JADARD_TEST_COLD_PACKETS);
+	KUNIT_EXPECT_EQ(test, last->bytes, JADARD_TEST_COLD_BYTES);
+	KUNIT_EXPECT_EQ(test, last->sleep_us, JADARD_TEST_COLD_DELAY_US);
+	KUNIT_EXPECT_EQ(test, jadard->cur_page, jadard->home_page);
+	KUNIT_EXPECT_TRUE(test, jadard->shadow_valid);
+}
+
+/* Within the autosuspend delay the registers survive, only the wake is left */
+static void jadard_test_prepare_warm(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+	KUNIT_ASSERT_EQ(test, jadard_disable(&jadard->panel), 0);
+	KUNIT_ASSERT_EQ(test, jadard_unprepare(&jadard->panel), 0);
+	jadard_test_reset_log(ctx);
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+
+	jadard_test_expect_wake(test);
+	jadard_test_check_log(test);
+	jadard_test_check_prepare(test);
+}
+
+/* A failed run is sent again from its page switch after a backoff */
+static void jadard_test_prepare_retry(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	/* The first write after the first page switch */
+	const unsigned int fail_at = 3;
+
+	ctx->fail_at = fail_at;
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+
+	jadard_test_expect_power_on(test);
+	jadard_test_expect_init(test, 0, fail_at);
+	jadard_test_expect_sleep(test, JADARD_INIT_RETRY_US);
+	jadard_test_expect_init(test, jadard_test_init_segment(test, fail_at),
+				UINT_MAX);
+	jadard_test_expect_config(test);
+	jadard_test_expect_wake(test);
+	jadard_test_check_log(test);
+	jadard_test_check_prepare(test);
+}
+
+static void jadard_test_disable(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	const struct jadard_timings *t = &jadard->timings;
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+	jadard_test_reset_log(ctx);
+
+	KUNIT_ASSERT_EQ(test, jadard_disable(&jadard->panel), 0);
+
+	jadard_test_expect_sleep(test, t->backlight_off_to_display_off_us);
+	jadard_test_expect_dcs(test, MIPI_DCS_SET_DISPLAY_OFF);
+	jadard_test_expect_sleep(test, t->display_off_to_enter_sleep_us);
+	jadard_test_expect_dcs(test, MIPI_DCS_ENTER_SLEEP_MODE);
+	jadard_test_expect_sleep(test, t->enter_sleep_to_reset_down_us);
+	jadard_test_check_log(test);
+
+	KUNIT_EXPECT_TRUE(test, jadard->asleep);
+}
+
+/* A colour table with one payload byte of a register off the home page flipped */
+static struct jadard_init_table jadard_test_colour_table(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	const struct jadard_panel_desc *desc = jadard->desc;
+	const struct jadard_reg_id *id = NULL;
+	struct jadard_shadow_reg *reg;
+	unsigned int i;
+	u8 *data;
+
+	for (i = 0; i < desc->num_colour_regs && !id; i++)
+		if (desc->colour_regs[i].page != jadard->home_page)
+			id = &desc->colour_regs[i];
+	KUNIT_ASSERT_NOT_NULL(test, id);
+
+	reg = jadard_shadow_find(jadard, id->page, id->cmd);
+	KUNIT_ASSERT_NOT_NULL(test, reg);
+	KUNIT_ASSERT_GE(test, reg->len, 2);
+
+	data = kunit_kzalloc(test, 4 + reg->len, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, data);
+
+	data[0] = JADARD_OP_PAGE;
+	data[1] = id->page;
+	data[2] = JADARD_OP_DCS;
+	data[3] = reg->len;
+	memcpy(&data[4], reg->data, reg->len);
+	data[5] ^= 0x01;
+
+	return (struct jadard_init_table){ .data = data, .len = 4 + reg->len };
+}
+
+static void jadard_test_colour_delta(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	struct jadard_init_table colour;
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+	colour = jadard_test_colour_table(test);
+	jadard_test_reset_log(ctx);
+
+	KUNIT_ASSERT_EQ(test, jadard_write_table_delta(jadard, &colour), 0);
+
+	/* Standard DCS sent afterwards must land on the home page again */
+	jadard_test_expect_page(test, colour.data[1]);
+	jadard_test_expect_write(test, &colour.data[4], colour.data[3]);
+	jadard_test_expect_page(test, jadard->home_page);
+	jadard_test_check_log(test);
+	KUNIT_EXPECT_EQ(test, jadard->cur_page, jadard->home_page);
+
+	/* The panel holds the table now, nothing is left to send */
+	jadard_test_reset_log(ctx);
+	KUNIT_ASSERT_EQ(test, jadard_write_table_delta(jadard, &colour), 0);
+	KUNIT_EXPECT_EQ(test, ctx->sent.count, 0);
+}
+
+static void jadard_test_colour_delta_error(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	struct jadard_init_table colour;
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+	colour = jadard_test_colour_table(test);
+	jadard_test_reset_log(ctx);
+
+	ctx->fail_at = 2;
+	KUNIT_EXPECT_EQ(test, jadard_write_table_delta(jadard, &colour), -EIO);
+
+	jadard_test_expect_page(test, colour.data[1]);
+	jadard_test_expect_write(test, &colour.data[4], colour.data[3]);
+	jadard_test_expect_page(test, jadard->home_page);
+	jadard_test_check_log(test);
+	KUNIT_EXPECT_EQ(test, jadard->cur_page, jadard->home_page);
+	KUNIT_EXPECT_FALSE(test, jadard->shadow_valid);
+}
+
+static void jadard_test_panel_is_live(struct kunit *test)
+{
+	struct jadard_test *ctx = test->priv;
+	struct jadard *jadard = ctx->jadard;
+	const struct jadard_panel_desc *desc = jadard->desc;
+	u64 packets;
+
+	KUNIT_ASSERT_EQ(test, jadard_prepare(&jadard->panel), 0);
+	jadard_test_reset_log(ctx);
+	packets = jadard->link.packets;
+
+	ctx->power_mode = MIPI_DCS_POWER_MODE_DISPLAY |
+			  MIPI_DCS_POWER_MODE_NORMAL | MIPI_DCS_POWER_MODE_SLEEP;
+	ctx->signature = desc->signature;
+	KUNIT_EXPECT_TRUE(test, jadard_panel_is_live(jadard));
+
+	jadard_test_expect_read(test, MIPI_DCS_GET_POWER_MODE);
+	if (desc->signature_reg) {
+		jadard_test_expect_page(test, desc->signature_page);
+		jadard_test_expect_read(test, desc->signature_reg);
+		if (desc->signature_page != jadard->home_page)
+			jadard_test_expect_page(test, jadard->home_page);
+	}
+	jadard_test_check_log(test);
+
+	KUNIT_EXPECT_EQ(test, jadard->link.packets - packets, ctx->transfers);
+	KUNIT_EXPECT_EQ(test, jadard->cur_page, jadard->home_page);
+
+	/* A panel that lost its registers fails the signature check */
+	ctx->signature = ~desc->signature;
+	KUNIT_EXPECT_EQ(test, jadard_panel_is_live(jadard),
+			!desc->signature_reg);
+}
+
+static void jadard_test_init_table_valid(struct kunit *test)
+{
+	static const u8 no_writes[] = {
+		JADARD_PAGE(0x01), JADARD_DELAY(10), JADARD_PAGE(0x00),
+	};
+	static const u8 truncated[] = { JADARD_OP_DCS, 0x03, 0xb0 };
+	static const u8 bad_op[] = { 0x03, 0x00, JADARD_DCS(0xb0, 0x01) };
+	static const u8 one_write[] = { JADARD_PAGE(0x00), JADARD_DCS(0xb0, 0x01) };
+	const struct jadard_init_table *builtin =
+		&shenzen_z34014_p30_365t_y1_desc.init_table;
+
+	KUNIT_EXPECT_FALSE(test, jadard_init_table_valid(NULL, 0));
+	KUNIT_EXPECT_FALSE(test, jadard_init_table_valid(no_writes,
+							 sizeof(no_writes)));
+	KUNIT_EXPECT_FALSE(test, jadard_init_table_valid(truncated,
+							 sizeof(truncated)));
+	KUNIT_EXPECT_FALSE(test, jadard_init_table_valid(bad_op,
+							 sizeof(bad_op)));
+	KUNIT_EXPECT_TRUE(test, jadard_init_table_valid(one_write,
+							sizeof(one_write)));
+	KUNIT_EXPECT_TRUE(test, jadard_init_table_valid(builtin->data,
+							builtin->len));
+}
+
+/* Runtime PM goes through the driver's callbacks without the driver bound */
+static struct dev_pm_domain jadard_test_pm_domain = {
+	.ops = {
+		RUNTIME_PM_OPS(jadard_runtime_suspend, jadard_runtime_resume,
+			       NULL)
+	},
+};
+
+static void jadard_test_unregister(void *data)
+{
+	mipi_dsi_device_unregister(data);
+}
+
+static void jadard_test_pm_disable(void *data)
+{
+	struct device *dev = data;
+
+	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
+	dev_pm_domain_set(dev, NULL);
+}
+
+static int jadard_test_init(struct kunit *test)
+{
+	const struct jadard_panel_desc *desc = &shenzen_z34014_p30_365t_y1_desc;
+	/* Not named after the driver, so it doesn't bind on its own */
+	struct mipi_dsi_device_info info = { .type = "jadard-kunit" };
+	struct jadard_test *ctx;
+	struct jadard *jadard;
+	struct device *dev;
+	int ret;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx);
+	test->priv = ctx;
+
+	ctx->host.dev = kunit_device_register(test, "jadard-kunit-host");
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, ctx->host.dev);
+	ctx->host.ops = &jadard_test_host_ops;
+
+	ctx->dsi = mipi_dsi_device_register_full(&ctx->host, &info);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, ctx->dsi);
+	ret = kunit_add_action_or_reset(test, jadard_test_unregister, ctx->dsi);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+
+	dev = &ctx->dsi->dev;
+	ctx->dsi->lanes = desc->lanes;
+	ctx->dsi->format = desc->format;
+	ctx->dsi->mode_flags = MIPI_DSI_MODE_LPM;
+
+	jadard = kunit_kzalloc(test, sizeof(*jadard), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, jadard);
+	ctx->jadard = jadard;
+
+	jadard->dsi = ctx->dsi;
+	jadard->desc = desc;
+	jadard->timings = desc->timings;
+	jadard->init_table = desc->init_table;
+	jadard->command_mode = desc->command_mode;
+	jadard->cur_page = -1;
+	jadard->asleep = true;
+	mutex_init(&jadard->stats_lock);
+	mutex_init(&jadard->reg_lock);
+	spin_lock_init(&jadard->te_lock);
+	init_completion(&jadard->te_done);
+	INIT_WORK(&jadard->power_up_work, jadard_power_up_work);
+	INIT_DELAYED_WORK(&jadard->esd_work, jadard_esd_work);
+	mipi_dsi_set_drvdata(ctx->dsi, jadard);
+
+	KUNIT_ASSERT_EQ(test, jadard_shadow_init(jadard), 0);
+
+	kunit_activate_static_stub(test, jadard_sleep, jadard_test_sleep);
+
+	dev_pm_domain_set(dev, &jadard_test_pm_domain);
+	pm_runtime_set_autosuspend_delay(dev, JADARD_TEST_AUTOSUSPEND_MS);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+	ret = kunit_add_action_or_reset(test, jadard_test_pm_disable, dev);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+
+	ctx->expect_lpm = true;
+
+	return 0;
+}
+
+static struct kunit_case jadard_test_cases[] = {
+	KUNIT_CASE(jadard_test_prepare_cold),
+	KUNIT_CASE(jadard_test_prepare_warm),
+	KUNIT_CASE(jadard_test_prepare_retry),
+	KUNIT_CASE(jadard_test_disable),
+	KUNIT_CASE(jadard_test_colour_delta),
+	KUNIT_CASE(jadard_test_colour_delta_error),
+	KUNIT_CASE(jadard_test_panel_is_live),
+	KUNIT_CASE(jadard_test_init_table_valid),
+	{ }
+};
+
+static struct kunit_suite jadard_test_suite = {
+	.name = "jadard-jd9365tn",
+	.init = jadard_test_init,
+	.test_cases = jadard_test_cases,
+};
+kunit_test_suite(jadard_test_suite);
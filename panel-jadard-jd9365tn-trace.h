@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Author:
+ * - Kirill Yatsenko <kiriyatsenko@gmail.com>
+ *
+ * Tracepoints at the power sequencing phase boundaries. When building out of
+ * tree the module needs the source directory on its include path:
+ *	CFLAGS_panel-jadard-jd9365tn.o := -I$(src)
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM jadard
+
+#if !defined(_PANEL_JADARD_JD9365TN_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _PANEL_JADARD_JD9365TN_TRACE_H
+
+#include <linux/device.h>
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(jadard_phase_begin,
+	TP_PROTO(struct device *dev, const char *phase),
+	TP_ARGS(dev, phase),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__string(phase, phase)
+	),
+	TP_fast_assign(
+		__assign_str(dev);
+		__assign_str(phase);
+	),
+	TP_printk("%s %s", __get_str(dev), __get_str(phase))
+);
+
+TRACE_EVENT(jadard_phase_end,
+	TP_PROTO(struct device *dev, const char *phase, s64 duration_us),
+	TP_ARGS(dev, phase, duration_us),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__string(phase, phase)
+		__field(s64, duration_us)
+	),
+	TP_fast_assign(
+		__assign_str(dev);
+		__assign_str(phase);
+		__entry->duration_us = duration_us;
+	),
+	TP_printk("%s %s took %lld us", __get_str(dev), __get_str(phase),
+		  __entry->duration_us)
+);
+
+#endif /* _PANEL_JADARD_JD9365TN_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE panel-jadard-jd9365tn-trace
+#include <trace/define_trace.h>
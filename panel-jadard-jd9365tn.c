@@ -6,419 +6,2220 @@
 
 #include <drm/drm_mipi_dsi.h>
 #include <drm/drm_modes.h>
+#include <drm/drm_of.h>
 #include <drm/drm_panel.h>
 #include <drm/drm_print.h>
 
+#include <kunit/static_stub.h>
+
 #include <linux/gpio/consumer.h>
+#include <linux/backlight.h>
+#include <linux/completion.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
+#include <linux/firmware.h>
+#include <linux/interrupt.h>
+#include <linux/jump_label.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/of.h>
+#include <linux/pm_runtime.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
+
+/* Rails and reset are only ever switched from the runtime PM callbacks */
+#ifndef CONFIG_PM
+#error "panel-jadard-jd9365tn needs CONFIG_PM"
+#endif
+
+#define CREATE_TRACE_POINTS
+#include "panel-jadard-jd9365tn-trace.h"
 
 struct jadard;
 
+enum jadard_phase {
+	JADARD_PHASE_POWER_ON,
+	JADARD_PHASE_LP11,
+	JADARD_PHASE_RESET,
+	JADARD_PHASE_INIT,
+	JADARD_PHASE_INIT_PAGE0,
+	JADARD_PHASE_INIT_PAGE1,
+	JADARD_PHASE_INIT_PAGE2,
+	JADARD_PHASE_INIT_PAGE3,
+	JADARD_PHASE_SLEEP_OUT,
+	JADARD_PHASE_DISPLAY_ON,
+	JADARD_PHASE_DISABLE,
+	JADARD_PHASE_SLEEP_IN,
+	JADARD_PHASE_POWER_OFF,
+	JADARD_PHASE_PREPARE,
+	JADARD_PHASE_UNPREPARE,
+	JADARD_PHASE_COUNT
+};
+
+static const char * const jadard_phase_names[JADARD_PHASE_COUNT] = {
+	[JADARD_PHASE_POWER_ON] = "power-on",
+	[JADARD_PHASE_LP11] = "lp11",
+	[JADARD_PHASE_RESET] = "reset",
+	[JADARD_PHASE_INIT] = "init",
+	[JADARD_PHASE_INIT_PAGE0] = "init-page0",
+	[JADARD_PHASE_INIT_PAGE1] = "init-page1",
+	[JADARD_PHASE_INIT_PAGE2] = "init-page2",
+	[JADARD_PHASE_INIT_PAGE3] = "init-page3",
+	[JADARD_PHASE_SLEEP_OUT] = "sleep-out",
+	[JADARD_PHASE_DISPLAY_ON] = "display-on",
+	[JADARD_PHASE_DISABLE] = "disable",
+	[JADARD_PHASE_SLEEP_IN] = "sleep-in",
+	[JADARD_PHASE_POWER_OFF] = "power-off",
+	[JADARD_PHASE_PREPARE] = "prepare",
+	[JADARD_PHASE_UNPREPARE] = "unprepare",
+};
+
+struct jadard_phase_stats {
+	u64 count;
+	s64 total_us;
+	s64 min_us;
+	s64 max_us;
+	s64 last_us;
+};
+
+/* Traffic and requested delays, every transfer goes through the helpers */
+struct jadard_link_stats {
+	u64 packets;
+	u64 bytes;
+	u64 sleep_us;
+};
+
+#define JADARD_MAX_LANES	4
+
+struct jadard_init_table {
+	const u8 *data;
+	size_t len;
+};
+
+#define JADARD_INIT_TABLE(table) { .data = (table), .len = ARRAY_SIZE(table) }
+
+/* Last value written to a paged register, DCS command followed by payload */
+struct jadard_shadow_reg {
+	u8 page;
+	u8 len;
+	u8 *data;
+};
+
+/* Power sequencing delays, all in microseconds */
+struct jadard_timings {
+	unsigned int vcioo_to_lp11_us;
+	unsigned int lp11_to_reset_us;
+	unsigned int reset_low_us;
+	unsigned int reset_pulse_us;
+	unsigned int reset_to_init_us;
+	unsigned int sleep_out_us;
+	unsigned int display_on_us;
+	unsigned int backlight_off_to_display_off_us;
+	unsigned int display_off_to_enter_sleep_us;
+	unsigned int enter_sleep_to_reset_down_us;
+	unsigned int reset_down_to_power_off_us;
+	unsigned int reset_up_to_power_off_us;
+};
+
+/* Register as addressed by the init tables */
+struct jadard_reg_id {
+	u8 page;
+	u8 cmd;
+};
+
+/* Content adaptive brightness control, DCS power save values */
+enum jadard_cabc {
+	JADARD_CABC_OFF,
+	JADARD_CABC_UI,
+	JADARD_CABC_STILL,
+	JADARD_CABC_MOVING,
+};
+
+/* Controller specifics shared by every panel built around the same chip */
+struct jadard_chip_desc {
+	const char *name;
+	u8 switch_page_cmd;
+};
+
 struct jadard_panel_desc {
-	const struct drm_display_mode mode;
+	const struct jadard_chip_desc *chip;
+	const struct drm_display_mode *modes;
+	unsigned int num_modes;
+	unsigned int max_lane_rate_mbps;
 	unsigned int lanes;
 	enum mipi_dsi_pixel_format format;
+	/* Lane counts and formats the init sequence can configure */
+	unsigned long lanes_mask;
+	unsigned long formats_mask;
+	/* Sent after the init table when running on a non-default lane count */
+	struct jadard_init_table lanes_init[JADARD_MAX_LANES + 1];
+	/* Optional, the init table is sent as is when unset */
 	int (*init)(struct jadard *jadard);
+	struct jadard_init_table init_table;
+	/* Optional blob under /lib/firmware replacing init_table */
+	const char *firmware;
+	bool init_in_hs_mode;
+	bool command_mode;
+	/* Gamma and colour registers user space may load calibrated values to */
+	const struct jadard_reg_id *colour_regs;
+	unsigned int num_colour_regs;
+	/* Scan direction follows the DCS address mode flip bits */
+	bool scan_flip;
+	/* Controller resyncs after the clock lane drops to LP in blanking */
+	bool clock_non_continuous;
+	u8 signature_page;
+	u8 signature_reg;
+	u8 signature;
+	/* Controller driven LED PWM, used unless DT names a backlight */
+	u16 max_brightness;
+	bool dimming;
+	enum jadard_cabc cabc;
 	bool lp11_before_reset;
 	bool reset_before_power_off_vcioo;
-	unsigned int vcioo_to_lp11_delay_ms;
-	unsigned int lp11_to_reset_delay_ms;
-	unsigned int backlight_off_to_display_off_delay_ms;
-	unsigned int display_off_to_enter_sleep_delay_ms;
-	unsigned int enter_sleep_to_reset_down_delay_ms;
+	const struct jadard_timings timings;
+	/* Expected upper bound for a prepare from power off */
+	unsigned int prepare_budget_us;
 };
 
 struct jadard {
 	struct drm_panel panel;
 	struct mipi_dsi_device *dsi;
 	const struct jadard_panel_desc *desc;
+	struct jadard_timings timings;
 	enum drm_panel_orientation orientation;
+	struct regulator_bulk_data supplies[2];
+	bool use_supplies;
+	bool supplies_enabled;
 	struct gpio_desc *vdd;
 	struct gpio_desc *vccio;
 	struct gpio_desc *reset;
 	struct gpio_desc *dbg;
+	struct gpio_desc *te;
+	struct completion te_done;
+	spinlock_t te_lock;
+	ktime_t te_last;
+	s64 te_period_us;
+	u64 te_count;
+	struct work_struct power_up_work;
+	struct delayed_work esd_work;
+	unsigned int esd_interval_ms;
+	u64 esd_checks;
+	u64 esd_failures;
+	u64 esd_recoveries;
+	struct mutex stats_lock;
+	struct jadard_phase_stats stats[JADARD_PHASE_COUNT];
+	struct jadard_link_stats link;
+	struct jadard_link_stats last_prepare;
+	s64 last_prepare_us;
+	const struct firmware *fw;
+	struct jadard_init_table init_table;
+	/* Serialises register programming against runtime updates */
+	struct mutex reg_lock;
+	const struct firmware *colour_fw;
+	struct jadard_init_table colour;
+	struct backlight_device *dcs_bl;
+	enum jadard_cabc cabc;
+	struct jadard_shadow_reg *shadow;
+	unsigned int num_shadow;
+	bool shadow_valid;
+	int cur_page;
+	/* Page the init table leaves selected, standard DCS goes out on it */
+	int home_page;
+	bool hs_init_failed;
+	bool initialized;
+	bool asleep;
+	bool handover;
+	/* Bootloader rails left up by a panel that wasn't taken over */
+	bool stale_rails;
+	bool command_mode;
+	bool idle;
+	bool flip;
+	bool shutdown;
+};
+
+#define JD9365TN_DCS_SWITCH_PAGE	0xde
+
+static const struct jadard_chip_desc jd9365tn_chip = {
+	.name = "jd9365tn",
+	.switch_page_cmd = JD9365TN_DCS_SWITCH_PAGE,
+};
+
+#define JADARD_AUTOSUSPEND_DELAY_MS	1000
+
+#define JADARD_TE_TIMEOUT_MS		50
+
+/* Per page segment, the backoff doubles from JADARD_INIT_RETRY_US */
+#define JADARD_INIT_RETRIES		3
+#define JADARD_INIT_RETRY_US		1000
+
+/* Write CTRL display bits */
+#define JADARD_CTRL_BCTRL		BIT(5)
+#define JADARD_CTRL_DD			BIT(3)
+#define JADARD_CTRL_BL			BIT(2)
+
+/*
+ * Init tables are packed byte streams of back to back entries:
+ *
+ *	JADARD_OP_DCS   <len> <cmd> <payload...>	(len covers cmd + payload)
+ *	JADARD_OP_PAGE  <page>
+ *	JADARD_OP_DELAY <ms>
+ */
+enum jadard_init_op {
+	JADARD_OP_DCS,
+	JADARD_OP_PAGE,
+	JADARD_OP_DELAY,
+};
+
+#define JADARD_DCS(cmd, seq...) \
+	JADARD_OP_DCS, sizeof((u8[]){ cmd, ##seq }), cmd, ##seq
+#define JADARD_PAGE(page)	JADARD_OP_PAGE, (page)
+#define JADARD_DELAY(ms)	JADARD_OP_DELAY, (ms)
+
+static inline struct jadard *panel_to_jadard(struct drm_panel *panel)
+{
+	return container_of(panel, struct jadard, panel);
+}
+
+#define JADARD_SLEEP_SLACK_US	200
+
+/*
+ * msleep() rounds up to whole jiffies, which on HZ=100 kernels adds 10 ms or
+ * more to every wait. Use hrtimer backed sleeps with a small fixed slack.
+ */
+static void jadard_sleep(struct jadard *jadard, unsigned int us)
+{
+	if (!us)
+		return;
+
+	jadard->link.sleep_us += us;
+
+	/* The KUnit suite runs the sequences on a virtual clock */
+	KUNIT_STATIC_STUB_REDIRECT(jadard_sleep, jadard, us);
+
+	if (us < 10)
+		udelay(us);
+	else
+		usleep_range(us, us + JADARD_SLEEP_SLACK_US);
+}
+
+static void jadard_sleep_multi(struct mipi_dsi_multi_context *dsi_ctx,
+			       unsigned int us)
+{
+	if (!dsi_ctx->accum_err)
+		jadard_sleep(mipi_dsi_get_drvdata(dsi_ctx->dsi), us);
+}
+
+static void jadard_write_multi(struct mipi_dsi_multi_context *dsi_ctx,
+			       const u8 *buf, size_t len)
+{
+	struct jadard *jadard = mipi_dsi_get_drvdata(dsi_ctx->dsi);
+
+	if (dsi_ctx->accum_err)
+		return;
+
+	mipi_dsi_dcs_write_buffer_multi(dsi_ctx, buf, len);
+	jadard->link.packets++;
+	jadard->link.bytes += len;
+}
+
+/* Standard DCS commands go through jadard_write_multi() like the rest */
+#define jadard_dcs_multi(dsi_ctx, cmd, seq...)				\
+	do {								\
+		const u8 d[] = { cmd, ##seq };				\
+									\
+		jadard_write_multi(dsi_ctx, d, sizeof(d));		\
+	} while (0)
+
+/* A read is one packet on the link, carrying the command byte */
+static int jadard_read(struct jadard *jadard, u8 cmd, void *data, size_t len)
+{
+	jadard->link.packets++;
+	jadard->link.bytes++;
+
+	return mipi_dsi_dcs_read(jadard->dsi, cmd, data, len);
+}
+
+/* Keeps the dbg GPIO triggers out of the hot paths unless benchmarking */
+static DEFINE_STATIC_KEY_FALSE(jadard_dbg);
+
+static bool dbg_phase_pulses;
+
+static int jadard_dbg_set(const char *val, const struct kernel_param *kp)
+{
+	bool old = dbg_phase_pulses;
+	int ret;
+
+	ret = param_set_bool(val, kp);
+	if (ret || old == dbg_phase_pulses)
+		return ret;
+
+	if (dbg_phase_pulses)
+		static_branch_inc(&jadard_dbg);
+	else
+		static_branch_dec(&jadard_dbg);
+
+	return 0;
+}
+
+static const struct kernel_param_ops jadard_dbg_ops = {
+	.set = jadard_dbg_set,
+	.get = param_get_bool,
+};
+module_param_cb(dbg_phase_pulses, &jadard_dbg_ops, &dbg_phase_pulses, 0644);
+MODULE_PARM_DESC(dbg_phase_pulses,
+		 "Mark phase edges and the init start on the dbg GPIO, 2n+1 pulses when phase n begins, 2n+2 when it ends");
+
+/* Each pulse is 2 us long, the longest train stays under 70 us */
+static void jadard_dbg_pulses(struct jadard *jadard, unsigned int count)
+{
+	while (count--) {
+		gpiod_set_value(jadard->dbg, 1);
+		udelay(1);
+		gpiod_set_value(jadard->dbg, 0);
+		udelay(1);
+	}
+}
+
+static ktime_t jadard_phase_begin(struct jadard *jadard,
+				  enum jadard_phase phase)
+{
+	trace_jadard_phase_begin(&jadard->dsi->dev, jadard_phase_names[phase]);
+
+	if (static_branch_unlikely(&jadard_dbg))
+		jadard_dbg_pulses(jadard, 2 * phase + 1);
+
+	return ktime_get();
+}
+
+static void jadard_phase_end(struct jadard *jadard, enum jadard_phase phase,
+			     ktime_t start)
+{
+	struct jadard_phase_stats *stats = &jadard->stats[phase];
+	s64 us = ktime_us_delta(ktime_get(), start);
+
+	trace_jadard_phase_end(&jadard->dsi->dev, jadard_phase_names[phase], us);
+
+	if (static_branch_unlikely(&jadard_dbg))
+		jadard_dbg_pulses(jadard, 2 * phase + 2);
+
+	mutex_lock(&jadard->stats_lock);
+	if (!stats->count || us < stats->min_us)
+		stats->min_us = us;
+	if (us > stats->max_us)
+		stats->max_us = us;
+	stats->last_us = us;
+	stats->total_us += us;
+	stats->count++;
+	mutex_unlock(&jadard->stats_lock);
+}
+
+static int jadard_enter_sleep(struct jadard *jadard)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	ktime_t start;
+
+	if (jadard->asleep)
+		return 0;
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_SLEEP_IN);
+
+	jadard_sleep_multi(&dsi_ctx, jadard->timings.display_off_to_enter_sleep_us);
+
+	jadard_dcs_multi(&dsi_ctx, MIPI_DCS_ENTER_SLEEP_MODE);
+
+	jadard_sleep_multi(&dsi_ctx, jadard->timings.enter_sleep_to_reset_down_us);
+
+	jadard_phase_end(jadard, JADARD_PHASE_SLEEP_IN, start);
+
+	jadard->asleep = true;
+
+	return dsi_ctx.accum_err;
+}
+
+static void jadard_esd_schedule(struct jadard *jadard)
+{
+	if (jadard->esd_interval_ms)
+		schedule_delayed_work(&jadard->esd_work,
+				      msecs_to_jiffies(jadard->esd_interval_ms));
+}
+
+/*
+ * Sleep-in goes out here while the DSI host is still up, the runtime PM
+ * callbacks only handle the rails and the reset line.
+ */
+static int jadard_disable(struct drm_panel *panel)
+{
+	struct jadard *jadard = panel_to_jadard(panel);
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	ktime_t start;
+
+	/* A displaying panel is what the watchdog checks for */
+	cancel_delayed_work_sync(&jadard->esd_work);
+
+	/* Already powered off by jadard_dsi_shutdown() */
+	if (jadard->shutdown)
+		return 0;
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_DISABLE);
+
+	jadard_sleep_multi(&dsi_ctx, jadard->timings.backlight_off_to_display_off_us);
+
+	jadard_dcs_multi(&dsi_ctx, MIPI_DCS_SET_DISPLAY_OFF);
+
+	jadard_phase_end(jadard, JADARD_PHASE_DISABLE, start);
+
+	if (dsi_ctx.accum_err)
+		return dsi_ctx.accum_err;
+
+	return jadard_enter_sleep(jadard);
+}
+
+/*
+ * Consecutive DCS writes between page switches and delays form a run. The
+ * DSI host API carries one packet per transfer, so a run is queued back to
+ * back and its error is only looked at once the whole run has been issued.
+ */
+static size_t jadard_send_run(struct mipi_dsi_multi_context *dsi_ctx,
+			      const u8 *table, size_t len)
+{
+	size_t i = 0;
+
+	while (i + 1 < len && table[i] == JADARD_OP_DCS) {
+		jadard_write_multi(dsi_ctx, &table[i + 2],
+						table[i + 1]);
+		i += 2 + table[i + 1];
+	}
+
+	return i;
+}
+
+#define JADARD_PHASE_INIT_PAGES \
+	(JADARD_PHASE_INIT_PAGE3 - JADARD_PHASE_INIT_PAGE0 + 1)
+
+static ktime_t jadard_page_phase_begin(struct jadard *jadard, int page)
+{
+	if (page < 0 || page >= JADARD_PHASE_INIT_PAGES)
+		return 0;
+
+	return jadard_phase_begin(jadard, JADARD_PHASE_INIT_PAGE0 + page);
+}
+
+static void jadard_page_phase_end(struct jadard *jadard, int page,
+				  ktime_t start)
+{
+	if (page < 0 || page >= JADARD_PHASE_INIT_PAGES)
+		return;
+
+	jadard_phase_end(jadard, JADARD_PHASE_INIT_PAGE0 + page, start);
+}
+
+static void jadard_select_page(struct jadard *jadard,
+			       struct mipi_dsi_multi_context *dsi_ctx, int page)
+{
+	u8 buf[2] = { jadard->desc->chip->switch_page_cmd, page };
+
+	/* Skip switches to the page that is already selected */
+	if (page < 0 || page == jadard->cur_page)
+		return;
+
+	jadard_write_multi(dsi_ctx, buf, sizeof(buf));
+	jadard->cur_page = dsi_ctx->accum_err ? -1 : page;
+}
+
+/*
+ * A failed run is retried from the page switch that starts its segment, so a
+ * glitch on the link costs one page worth of writes instead of a power cycle.
+ */
+static int jadard_send_init_table(struct jadard *jadard,
+				  const struct jadard_init_table *init_table)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	const u8 *table = init_table->data;
+	size_t len = init_table->len;
+	unsigned int retries = 0;
+	ktime_t page_start = 0;
+	int table_page = -1;
+	size_t segment = 0;
+	size_t i = 0;
+
+	while (i + 1 < len) {
+		switch (table[i]) {
+		case JADARD_OP_DCS:
+			i += jadard_send_run(&dsi_ctx, &table[i], len - i);
+			if (!dsi_ctx.accum_err)
+				break;
+
+			if (retries == JADARD_INIT_RETRIES) {
+				jadard_page_phase_end(jadard, table_page,
+						      page_start);
+				dev_err(&jadard->dsi->dev,
+					"init run before offset %zu on page %d failed: %d\n",
+					i, table_page, dsi_ctx.accum_err);
+				return dsi_ctx.accum_err;
+			}
+
+			dev_dbg(&jadard->dsi->dev,
+				"init run before offset %zu on page %d failed: %d, retrying\n",
+				i, table_page, dsi_ctx.accum_err);
+			jadard_sleep(jadard, JADARD_INIT_RETRY_US << retries++);
+			dsi_ctx.accum_err = 0;
+			/* The page switch may not have made it either */
+			jadard->cur_page = -1;
+			i = segment;
+			break;
+		case JADARD_OP_PAGE:
+			if (i != segment)
+				retries = 0;
+			segment = i;
+			if (table[i + 1] != table_page) {
+				jadard_page_phase_end(jadard, table_page,
+						      page_start);
+				table_page = table[i + 1];
+				page_start = jadard_page_phase_begin(jadard,
+								     table_page);
+			}
+			jadard_select_page(jadard, &dsi_ctx, table[i + 1]);
+			i += 2;
+			break;
+		case JADARD_OP_DELAY:
+			jadard_sleep_multi(&dsi_ctx, table[i + 1] * USEC_PER_MSEC);
+			i += 2;
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	jadard_page_phase_end(jadard, table_page, page_start);
+
+	return dsi_ctx.accum_err;
+}
+
+static size_t jadard_entry_len(const u8 *entry)
+{
+	return entry[0] == JADARD_OP_DCS ? 2 + entry[1] : 2;
+}
+
+/*
+ * The shadow mirrors every paged register the init table writes. It is what
+ * the panel holds once the init table went through, until the next reset.
+ */
+static int jadard_shadow_init(struct jadard *jadard)
+{
+	const struct jadard_init_table *table = &jadard->init_table;
+	struct device *dev = &jadard->dsi->dev;
+	unsigned int n = 0;
+	int page = -1;
+	u8 *data;
+	size_t i;
+
+	for (i = 0; i + 1 < table->len; i += jadard_entry_len(&table->data[i]))
+		if (table->data[i] == JADARD_OP_DCS)
+			n++;
+
+	jadard->shadow = devm_kcalloc(dev, n, sizeof(*jadard->shadow),
+				      GFP_KERNEL);
+	data = devm_kmemdup(dev, table->data, table->len, GFP_KERNEL);
+	if (!jadard->shadow || !data)
+		return -ENOMEM;
+
+	for (i = 0; i + 1 < table->len; i += jadard_entry_len(&table->data[i])) {
+		struct jadard_shadow_reg *reg = &jadard->shadow[jadard->num_shadow];
+
+		if (table->data[i] == JADARD_OP_PAGE)
+			page = table->data[i + 1];
+
+		if (table->data[i] != JADARD_OP_DCS)
+			continue;
+
+		reg->page = page;
+		reg->len = table->data[i + 1];
+		reg->data = &data[i + 2];
+		jadard->num_shadow++;
+	}
+
+	/* The controller comes out of reset on page 0 */
+	jadard->home_page = page < 0 ? 0 : page;
+
+	return 0;
+}
+
+/* Called once the init table reached the panel */
+static void jadard_shadow_reset(struct jadard *jadard)
+{
+	const struct jadard_init_table *table = &jadard->init_table;
+	unsigned int n = 0;
+	size_t i;
+
+	for (i = 0; i + 1 < table->len; i += jadard_entry_len(&table->data[i])) {
+		if (table->data[i] != JADARD_OP_DCS)
+			continue;
+
+		memcpy(jadard->shadow[n++].data, &table->data[i + 2],
+		       table->data[i + 1]);
+	}
+
+	jadard->shadow_valid = true;
+}
+
+static struct jadard_shadow_reg *jadard_shadow_find(struct jadard *jadard,
+						    int page, u8 cmd)
+{
+	unsigned int i;
+
+	/* Tables may write a register twice, the last write is what sticks */
+	for (i = jadard->num_shadow; i-- > 0; )
+		if (jadard->shadow[i].page == (u8)page &&
+		    jadard->shadow[i].data[0] == cmd)
+			return &jadard->shadow[i];
+
+	return NULL;
+}
+
+/*
+ * Only writes the entries of @table the panel doesn't already hold, and
+ * only switches pages when there is something to write on them. A page
+ * switch is undone once done, so later standard DCS commands land on the
+ * page the init table left selected.
+ */
+static int jadard_write_table_delta(struct jadard *jadard,
+				    const struct jadard_init_table *table)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	int start_page = jadard->cur_page;
+	int page = jadard->cur_page;
+	size_t i;
+
+	for (i = 0; i + 1 < table->len && !dsi_ctx.accum_err;
+	     i += jadard_entry_len(&table->data[i])) {
+		const u8 *entry = &table->data[i];
+		struct jadard_shadow_reg *reg;
+
+		switch (entry[0]) {
+		case JADARD_OP_PAGE:
+			page = entry[1];
+			break;
+		case JADARD_OP_DELAY:
+			jadard_sleep_multi(&dsi_ctx, entry[1] * USEC_PER_MSEC);
+			break;
+		case JADARD_OP_DCS:
+			reg = jadard_shadow_find(jadard, page, entry[2]);
+			if (reg && reg->len != entry[1])
+				reg = NULL;
+
+			if (reg && jadard->shadow_valid &&
+			    !memcmp(reg->data, &entry[2], reg->len))
+				break;
+
+			jadard_select_page(jadard, &dsi_ctx, page);
+			jadard_write_multi(&dsi_ctx, &entry[2],
+							entry[1]);
+			if (reg && !dsi_ctx.accum_err)
+				memcpy(reg->data, &entry[2], reg->len);
+			break;
+		default:
+			dsi_ctx.accum_err = -EINVAL;
+			break;
+		}
+	}
+
+	if (jadard->cur_page != start_page) {
+		/*
+		 * Still try to get back after a failed write, the page the
+		 * panel is on is unknown then and cur_page forces the switch.
+		 */
+		struct mipi_dsi_multi_context home_ctx = { .dsi = jadard->dsi };
+
+		jadard_select_page(jadard, &home_ctx, jadard->home_page);
+	}
+
+	/* A failed write leaves the register contents unknown */
+	if (dsi_ctx.accum_err)
+		jadard->shadow_valid = false;
+
+	return dsi_ctx.accum_err;
+}
+
+static void jadard_reset(struct jadard *jadard)
+{
+	jadard->shadow_valid = false;
+	jadard->cur_page = -1;
+
+	gpiod_set_value(jadard->reset, 0);
+	jadard_sleep(jadard, jadard->timings.reset_low_us);
+
+	gpiod_set_value(jadard->reset, 1);
+	jadard_sleep(jadard, jadard->timings.reset_pulse_us);
+
+	gpiod_set_value(jadard->reset, 0);
+	jadard_sleep(jadard, jadard->timings.reset_to_init_us);
+}
+
+static u8 jadard_dcs_pixel_format(enum mipi_dsi_pixel_format format)
+{
+	switch (format) {
+	case MIPI_DSI_FMT_RGB565:
+		return MIPI_DCS_PIXEL_FMT_16BIT;
+	case MIPI_DSI_FMT_RGB666:
+	case MIPI_DSI_FMT_RGB666_PACKED:
+		return MIPI_DCS_PIXEL_FMT_18BIT;
+	default:
+		return MIPI_DCS_PIXEL_FMT_24BIT;
+	}
+}
+
+/*
+ * The init table is written for the descriptor's default lanes and format,
+ * anything else selected from DT is programmed on top of it.
+ */
+static int jadard_send_interface_config(struct jadard *jadard)
+{
+	const struct jadard_panel_desc *desc = jadard->desc;
+	struct mipi_dsi_device *dsi = jadard->dsi;
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = dsi };
+	u8 format;
+	int ret;
+
+	if (dsi->lanes != desc->lanes) {
+		ret = jadard_write_table_delta(jadard, &desc->lanes_init[dsi->lanes]);
+		if (ret)
+			return ret;
+	}
+
+	if (dsi->format != desc->format || jadard->command_mode) {
+		format = jadard_dcs_pixel_format(dsi->format);
+		jadard_dcs_multi(&dsi_ctx, MIPI_DCS_SET_PIXEL_FORMAT,
+				 format << 4 | format);
+	}
+
+	if (jadard->flip) {
+		u8 mode[2] = { MIPI_DCS_SET_ADDRESS_MODE,
+			       MIPI_DCS_ADDRESS_MODE_FLIP_HORIZONTAL |
+			       MIPI_DCS_ADDRESS_MODE_FLIP_VERTICAL };
+
+		jadard_write_multi(&dsi_ctx, mode, sizeof(mode));
+	}
+
+	return dsi_ctx.accum_err;
+}
+
+/* Same byte order as mipi_dsi_dcs_set_display_brightness() */
+static void jadard_set_brightness_multi(struct mipi_dsi_multi_context *dsi_ctx,
+					u16 brightness)
+{
+	jadard_dcs_multi(dsi_ctx, MIPI_DCS_SET_DISPLAY_BRIGHTNESS,
+			 brightness & 0xff, brightness >> 8);
+}
+
+/* Sends the backlight core's level, which starts out at max_brightness */
+static int jadard_dcs_backlight_init(struct jadard *jadard)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	u8 ctrl[2] = { MIPI_DCS_WRITE_CONTROL_DISPLAY,
+		       JADARD_CTRL_BCTRL | JADARD_CTRL_BL };
+	u8 cabc[2] = { MIPI_DCS_WRITE_POWER_SAVE, jadard->cabc };
+
+	if (!jadard->dcs_bl)
+		return 0;
+
+	if (jadard->desc->dimming)
+		ctrl[1] |= JADARD_CTRL_DD;
+
+	jadard_set_brightness_multi(&dsi_ctx,
+				    backlight_get_brightness(jadard->dcs_bl));
+	jadard_write_multi(&dsi_ctx, ctrl, sizeof(ctrl));
+	jadard_write_multi(&dsi_ctx, cabc, sizeof(cabc));
+
+	return dsi_ctx.accum_err;
+}
+
+/* Idle mode drops the panel to 8 colours, survives sleep but not reset */
+static int jadard_send_idle(struct jadard *jadard)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+
+	jadard_dcs_multi(&dsi_ctx, jadard->idle ? MIPI_DCS_ENTER_IDLE_MODE :
+						  MIPI_DCS_EXIT_IDLE_MODE);
+
+	return dsi_ctx.accum_err;
+}
+
+/*
+ * Everything programmed on top of the init table. A panel taken over from
+ * the bootloader gets it too, the bootloader only knows the init table.
+ */
+static int jadard_send_config(struct jadard *jadard)
+{
+	int ret;
+
+	if (jadard->colour.len) {
+		ret = jadard_write_table_delta(jadard, &jadard->colour);
+		if (ret)
+			return ret;
+	}
+
+	ret = jadard_send_interface_config(jadard);
+	if (ret)
+		return ret;
+
+	if (jadard->idle) {
+		ret = jadard_send_idle(jadard);
+		if (ret)
+			return ret;
+	}
+
+	return jadard_dcs_backlight_init(jadard);
+}
+
+static int jadard_run_init(struct jadard *jadard)
+{
+	int ret;
+
+	if (jadard->desc->init)
+		ret = jadard->desc->init(jadard);
+	else
+		ret = jadard_send_init_table(jadard, &jadard->init_table);
+	if (ret)
+		return ret;
+
+	jadard_shadow_reset(jadard);
+
+	return jadard_send_config(jadard);
+}
+
+/*
+ * Register programming goes out in HS mode when the panel allows it. If the
+ * host fails to deliver it, reset the panel and stay in LP mode from then on.
+ */
+static int jadard_do_init(struct jadard *jadard)
+{
+	struct mipi_dsi_device *dsi = jadard->dsi;
+	int ret;
+
+	if (!jadard->desc->init_in_hs_mode || jadard->hs_init_failed)
+		return jadard_run_init(jadard);
+
+	dsi->mode_flags &= ~MIPI_DSI_MODE_LPM;
+	ret = jadard_run_init(jadard);
+	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+	if (!ret)
+		return 0;
+
+	dev_warn(&dsi->dev, "HS init failed (%d), falling back to LP mode\n", ret);
+	jadard->hs_init_failed = true;
+
+	jadard_reset(jadard);
+
+	return jadard_run_init(jadard);
+}
+
+static int jadard_init(struct jadard *jadard)
+{
+	ktime_t start = jadard_phase_begin(jadard, JADARD_PHASE_INIT);
+	int ret;
+
+	ret = jadard_do_init(jadard);
+
+	jadard_phase_end(jadard, JADARD_PHASE_INIT, start);
+
+	return ret;
+}
+
+static irqreturn_t jadard_te_irq(int irq, void *data)
+{
+	struct jadard *jadard = data;
+	ktime_t now = ktime_get();
+	unsigned long flags;
+
+	spin_lock_irqsave(&jadard->te_lock, flags);
+	if (jadard->te_count)
+		jadard->te_period_us = ktime_us_delta(now, jadard->te_last);
+	jadard->te_last = now;
+	jadard->te_count++;
+	spin_unlock_irqrestore(&jadard->te_lock, flags);
+
+	complete_all(&jadard->te_done);
+
+	return IRQ_HANDLED;
+}
+
+/*
+ * TE rises as the panel enters vertical blanking, waiting for it before
+ * touching GRAM keeps the update clear of the scanout.
+ */
+static void jadard_wait_for_te(struct jadard *jadard)
+{
+	if (!jadard->te || !jadard->initialized)
+		return;
+
+	reinit_completion(&jadard->te_done);
+	if (!wait_for_completion_timeout(&jadard->te_done,
+					 msecs_to_jiffies(JADARD_TE_TIMEOUT_MS)))
+		dev_warn_ratelimited(&jadard->dsi->dev, "timed out waiting for TE\n");
+}
+
+/*
+ * In command mode the host pushes pixels into GRAM with write_memory_start,
+ * which fills the column/page window programmed here.
+ */
+static int jadard_set_window(struct jadard *jadard, u16 x1, u16 y1, u16 x2,
+			     u16 y2)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+
+	jadard_wait_for_te(jadard);
+
+	jadard_dcs_multi(&dsi_ctx, MIPI_DCS_SET_COLUMN_ADDRESS,
+			 x1 >> 8, x1 & 0xff, x2 >> 8, x2 & 0xff);
+	jadard_dcs_multi(&dsi_ctx, MIPI_DCS_SET_PAGE_ADDRESS,
+			 y1 >> 8, y1 & 0xff, y2 >> 8, y2 & 0xff);
+
+	return dsi_ctx.accum_err;
+}
+
+/*
+ * The full screen window set up here is left alone afterwards. That way the
+ * host can stop sending frames at any point, e.g. for DRM self-refresh, with
+ * the panel refreshing from GRAM, and resume with a plain write_memory_start.
+ */
+static int jadard_command_mode_init(struct jadard *jadard)
+{
+	const struct drm_display_mode *mode = &jadard->desc->modes[0];
+
+	return jadard_set_window(jadard, 0, 0, mode->hdisplay - 1,
+				 mode->vdisplay - 1);
+}
+
+static int jadard_exit_sleep(struct jadard *jadard)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	ktime_t start;
+
+	if (jadard->asleep) {
+		start = jadard_phase_begin(jadard, JADARD_PHASE_SLEEP_OUT);
+		jadard_dcs_multi(&dsi_ctx, MIPI_DCS_EXIT_SLEEP_MODE);
+		jadard_sleep_multi(&dsi_ctx, jadard->timings.sleep_out_us);
+		jadard_phase_end(jadard, JADARD_PHASE_SLEEP_OUT, start);
+		if (dsi_ctx.accum_err)
+			return dsi_ctx.accum_err;
+
+		jadard->asleep = false;
+	}
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_DISPLAY_ON);
+	jadard_dcs_multi(&dsi_ctx, MIPI_DCS_SET_DISPLAY_ON);
+	jadard_sleep_multi(&dsi_ctx, jadard->timings.display_on_us);
+	jadard_phase_end(jadard, JADARD_PHASE_DISPLAY_ON, start);
+
+	return dsi_ctx.accum_err;
+}
+
+/*
+ * The bulk enable brings the regulators up in parallel and returns once the
+ * slowest one has finished its ramp, so no fixed settle time is needed on
+ * top of it. The enable GPIOs of the adapter board come up together.
+ */
+static int jadard_supplies_on(struct jadard *jadard)
+{
+	int ret;
+
+	if (jadard->use_supplies && !jadard->supplies_enabled) {
+		ret = regulator_bulk_enable(ARRAY_SIZE(jadard->supplies),
+					    jadard->supplies);
+		if (ret)
+			return ret;
+
+		jadard->supplies_enabled = true;
+	}
+
+	gpiod_set_value(jadard->vccio, 1);
+	gpiod_set_value(jadard->vdd, 1);
+
+	return 0;
+}
+
+static void jadard_supplies_off(struct jadard *jadard)
+{
+	gpiod_set_value(jadard->vdd, 0);
+	gpiod_set_value(jadard->vccio, 0);
+
+	if (jadard->supplies_enabled) {
+		regulator_bulk_disable(ARRAY_SIZE(jadard->supplies),
+				       jadard->supplies);
+		jadard->supplies_enabled = false;
+	}
+}
+
+static void jadard_power_off(struct jadard *jadard)
+{
+	ktime_t start = jadard_phase_begin(jadard, JADARD_PHASE_POWER_OFF);
+
+	gpiod_set_value(jadard->reset, 0);
+	jadard_sleep(jadard, jadard->timings.reset_down_to_power_off_us);
+
+	if (jadard->desc->reset_before_power_off_vcioo) {
+		gpiod_set_value(jadard->reset, 1);
+
+		jadard_sleep(jadard, jadard->timings.reset_up_to_power_off_us);
+	}
+
+	jadard_supplies_off(jadard);
+
+	jadard_phase_end(jadard, JADARD_PHASE_POWER_OFF, start);
+}
+
+static int jadard_power_on(struct jadard *jadard)
+{
+	ktime_t start;
+	int ret;
+
+	jadard->initialized = false;
+	jadard->asleep = true;
+
+	/* Drop the bootloader's rails for a clean cold start */
+	if (jadard->stale_rails) {
+		ret = jadard_supplies_on(jadard);
+		if (ret)
+			return ret;
+
+		jadard_power_off(jadard);
+		jadard->stale_rails = false;
+	}
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_POWER_ON);
+	ret = jadard_supplies_on(jadard);
+	if (ret) {
+		jadard_phase_end(jadard, JADARD_PHASE_POWER_ON, start);
+		return ret;
+	}
+
+	jadard_sleep(jadard, jadard->timings.vcioo_to_lp11_us);
+	jadard_phase_end(jadard, JADARD_PHASE_POWER_ON, start);
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_LP11);
+	if (jadard->desc->lp11_before_reset) {
+		struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+
+		jadard_dcs_multi(&dsi_ctx, MIPI_DCS_NOP);
+		if (dsi_ctx.accum_err)
+			return dsi_ctx.accum_err;
+	}
+
+	jadard_sleep(jadard, jadard->timings.lp11_to_reset_us);
+	jadard_phase_end(jadard, JADARD_PHASE_LP11, start);
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_RESET);
+	jadard_reset(jadard);
+	jadard_phase_end(jadard, JADARD_PHASE_RESET, start);
+
+	return 0;
+}
+
+/*
+ * Rails and reset are owned by runtime PM. If the panel was unprepared
+ * recently enough for autosuspend not to have dropped the rails it is merely
+ * in sleep mode with its registers intact, and waking it up only takes a
+ * sleep-out. A resume already started by the power-up work is waited for
+ * by runtime PM, so only the part of it that is still left blocks here.
+ */
+static int jadard_setup_registers(struct jadard *jadard)
+{
+	int ret;
+
+	if (jadard->initialized)
+		return 0;
+
+	ret = jadard_init(jadard);
+	if (ret)
+		return ret;
+
+	if (jadard->command_mode) {
+		ret = jadard_command_mode_init(jadard);
+		if (ret)
+			return ret;
+	}
+
+	jadard->initialized = true;
+
+	return 0;
+}
+
+/*
+ * What a prepare put on the link and how long it asked to sleep, so changes
+ * to the sequence that add transfers or delays show up in link_stats.
+ */
+static void jadard_account_prepare(struct jadard *jadard,
+				   const struct jadard_link_stats *before,
+				   ktime_t start)
+{
+	struct jadard_link_stats *last = &jadard->last_prepare;
+	unsigned int budget_us = jadard->desc->prepare_budget_us;
+
+	last->packets = jadard->link.packets - before->packets;
+	last->bytes = jadard->link.bytes - before->bytes;
+	last->sleep_us = jadard->link.sleep_us - before->sleep_us;
+	jadard->last_prepare_us = ktime_us_delta(ktime_get(), start);
+
+	if (budget_us && jadard->last_prepare_us > budget_us)
+		dev_warn(&jadard->dsi->dev,
+			 "prepare took %lld us, over the %u us budget (%llu packets, %llu bytes, %llu us of delays)\n",
+			 jadard->last_prepare_us, budget_us, last->packets,
+			 last->bytes, last->sleep_us);
+}
+
+static int jadard_prepare(struct drm_panel *panel)
+{
+	struct jadard *jadard = panel_to_jadard(panel);
+	struct device *dev = &jadard->dsi->dev;
+	struct jadard_link_stats before = jadard->link;
+	ktime_t start;
+	int ret;
+
+	/* The bootloader left the panel on, use the reference taken at probe */
+	if (jadard->handover) {
+		jadard->handover = false;
+
+		mutex_lock(&jadard->reg_lock);
+		ret = jadard_send_config(jadard);
+		if (!ret && jadard->command_mode)
+			ret = jadard_command_mode_init(jadard);
+		mutex_unlock(&jadard->reg_lock);
+		if (ret) {
+			pm_runtime_put_sync_suspend(dev);
+			return ret;
+		}
+
+		jadard_esd_schedule(jadard);
+		return 0;
+	}
+
+	start = jadard_phase_begin(jadard, JADARD_PHASE_PREPARE);
+
+	ret = pm_runtime_resume_and_get(dev);
+	if (ret < 0)
+		goto err_end;
+
+	mutex_lock(&jadard->reg_lock);
+	ret = jadard_setup_registers(jadard);
+	mutex_unlock(&jadard->reg_lock);
+	if (ret)
+		goto err_suspend;
+
+	ret = jadard_exit_sleep(jadard);
+	if (ret)
+		goto err_suspend;
+
+	jadard_account_prepare(jadard, &before, start);
+	jadard_phase_end(jadard, JADARD_PHASE_PREPARE, start);
+	jadard_esd_schedule(jadard);
+
+	return 0;
+
+err_suspend:
+	/* Don't trust the registers, go through a cold start next time */
+	pm_runtime_put_sync_suspend(dev);
+err_end:
+	jadard_phase_end(jadard, JADARD_PHASE_PREPARE, start);
+
+	return ret;
+}
+
+static int jadard_unprepare(struct drm_panel *panel)
+{
+	struct jadard *jadard = panel_to_jadard(panel);
+	struct device *dev = &jadard->dsi->dev;
+	ktime_t start = jadard_phase_begin(jadard, JADARD_PHASE_UNPREPARE);
+
+	pm_runtime_mark_last_busy(dev);
+	pm_runtime_put_autosuspend(dev);
+
+	jadard_phase_end(jadard, JADARD_PHASE_UNPREPARE, start);
+
+	return 0;
+}
+
+static bool async_power_up;
+module_param(async_power_up, bool, 0644);
+MODULE_PARM_DESC(async_power_up,
+		 "Power up and reset the panel ahead of prepare, from a workqueue");
+
+static void jadard_power_up_work(struct work_struct *work)
+{
+	struct jadard *jadard = container_of(work, struct jadard, power_up_work);
+	struct device *dev = &jadard->dsi->dev;
+
+	/* Rails drop again after the autosuspend delay if nobody prepares */
+	if (pm_runtime_resume_and_get(dev) < 0)
+		return;
+
+	pm_runtime_mark_last_busy(dev);
+	pm_runtime_put_autosuspend(dev);
+}
+
+/*
+ * Ramping the rails and waiting out the reset recovery doesn't need the DSI
+ * host, unless the panel wants LP-11 before reset, so it can overlap with
+ * the rest of the display pipeline coming up.
+ */
+static void jadard_power_up_async(struct jadard *jadard)
+{
+	if (!async_power_up || jadard->desc->lp11_before_reset)
+		return;
+
+	queue_work(system_unbound_wq, &jadard->power_up_work);
+}
+
+/*
+ * A panel brought up by the bootloader is sleeping out with the display on,
+ * and still holds the signature value programmed by the init table.
+ */
+static bool jadard_panel_is_live(struct jadard *jadard)
+{
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	u8 mode, val;
+	int ret;
+
+	ret = jadard_read(jadard, MIPI_DCS_GET_POWER_MODE, &mode, sizeof(mode));
+	if (ret != sizeof(mode))
+		return false;
+
+	if ((mode & (MIPI_DCS_POWER_MODE_DISPLAY | MIPI_DCS_POWER_MODE_NORMAL |
+		     MIPI_DCS_POWER_MODE_SLEEP)) !=
+	    (MIPI_DCS_POWER_MODE_DISPLAY | MIPI_DCS_POWER_MODE_NORMAL |
+	     MIPI_DCS_POWER_MODE_SLEEP))
+		return false;
+
+	if (!jadard->desc->signature_reg)
+		return true;
+
+	/* A glitched panel may be on any page, don't trust cur_page */
+	jadard->cur_page = -1;
+	jadard_select_page(jadard, &dsi_ctx, jadard->desc->signature_page);
+	if (dsi_ctx.accum_err)
+		return false;
+
+	ret = jadard_read(jadard, jadard->desc->signature_reg, &val,
+			  sizeof(val));
+	if (ret != sizeof(val))
+		return false;
+
+	/* Standard DCS sent from here on expects the init table's last page */
+	jadard_select_page(jadard, &dsi_ctx, jadard->home_page);
+	if (dsi_ctx.accum_err)
+		return false;
+
+	return val == jadard->desc->signature;
+}
+
+/*
+ * ESD hits show up as the panel leaving normal display mode or dropping its
+ * registers. Recovery is a reset and the register init with the rails and
+ * the DSI link kept up, the DRM pipeline doesn't notice.
+ */
+static int jadard_esd_recover(struct jadard *jadard)
+{
+	int ret;
+
+	jadard->initialized = false;
+	jadard->asleep = true;
+	jadard_reset(jadard);
+
+	ret = jadard_setup_registers(jadard);
+	if (ret)
+		return ret;
+
+	return jadard_exit_sleep(jadard);
+}
+
+static void jadard_esd_work(struct work_struct *work)
+{
+	struct jadard *jadard = container_of(to_delayed_work(work),
+					     struct jadard, esd_work);
+	struct device *dev = &jadard->dsi->dev;
+	int ret;
+
+	if (pm_runtime_get_if_in_use(dev) <= 0)
+		return;
+
+	mutex_lock(&jadard->reg_lock);
+
+	/* Keep the readback clear of GRAM updates */
+	jadard_wait_for_te(jadard);
+
+	jadard->esd_checks++;
+	if (!jadard_panel_is_live(jadard)) {
+		jadard->esd_failures++;
+		dev_warn(dev, "panel stopped responding, reinitializing\n");
+
+		ret = jadard_esd_recover(jadard);
+		if (ret)
+			dev_err(dev, "ESD recovery failed: %d\n", ret);
+		else
+			jadard->esd_recoveries++;
+	}
+
+	mutex_unlock(&jadard->reg_lock);
+	pm_runtime_put(dev);
+
+	jadard_esd_schedule(jadard);
+}
+
+static int jadard_runtime_suspend(struct device *dev)
+{
+	struct jadard *jadard = dev_get_drvdata(dev);
+
+	jadard_power_off(jadard);
+
+	return 0;
+}
+
+static int jadard_runtime_resume(struct device *dev)
+{
+	struct jadard *jadard = dev_get_drvdata(dev);
+	int ret;
+
+	ret = jadard_power_on(jadard);
+	if (ret)
+		jadard_power_off(jadard);
+
+	return ret;
+}
+
+/* Skip modes the DSI link can't carry with the configured lanes and format */
+static bool jadard_mode_fits_link(struct jadard *jadard,
+				  const struct drm_display_mode *mode)
+{
+	struct mipi_dsi_device *dsi = jadard->dsi;
+	u64 lane_rate_kbps;
+
+	if (!jadard->desc->max_lane_rate_mbps)
+		return true;
+
+	lane_rate_kbps = div_u64((u64)mode->clock *
+				 mipi_dsi_pixel_format_to_bpp(dsi->format),
+				 dsi->lanes);
+
+	return lane_rate_kbps <= jadard->desc->max_lane_rate_mbps * 1000ULL;
+}
+
+static int jadard_get_modes(struct drm_panel *panel,
+			    struct drm_connector *connector)
+{
+	struct jadard *jadard = panel_to_jadard(panel);
+	const struct jadard_panel_desc *desc = jadard->desc;
+	struct drm_display_mode *mode;
+	unsigned int i;
+	int count = 0;
+
+	for (i = 0; i < desc->num_modes; i++) {
+		const struct drm_display_mode *desc_mode = &desc->modes[i];
+
+		if (!jadard_mode_fits_link(jadard, desc_mode))
+			continue;
+
+		mode = drm_mode_duplicate(connector->dev, desc_mode);
+		if (!mode) {
+			DRM_DEV_ERROR(&jadard->dsi->dev, "failed to add mode %ux%ux@%u\n",
+				      desc_mode->hdisplay, desc_mode->vdisplay,
+				      drm_mode_vrefresh(desc_mode));
+			return -ENOMEM;
+		}
+
+		drm_mode_set_name(mode);
+		drm_mode_probed_add(connector, mode);
+		count++;
+	}
+
+	connector->display_info.width_mm = desc->modes[0].width_mm;
+	connector->display_info.height_mm = desc->modes[0].height_mm;
+
+	return count;
+}
+
+static enum drm_panel_orientation jadard_panel_get_orientation(struct drm_panel *panel)
+{
+	struct jadard *jadard = panel_to_jadard(panel);
+
+	return jadard->orientation;
+}
+
+static int complex_dbg_pattern=0;
+module_param(complex_dbg_pattern,int,0660);
+
+/*
+ * https://regexr.com/
+ *
+ * Used regex to convert for manufacturer's init code
+ *	{(0x..),.[1-9]+,.{(.+)}},
+ *
+ * With replaced value:
+ *	JADARD_DCS($1, $2),
+ *
+ * And then run ClangFormat
+ *
+ */
+static const u8 shenzen_z34014_p30_365t_y1_init_table[] = {
+	JADARD_DCS(0xDF, 0x90, 0x69, 0xF9),
+	JADARD_PAGE(0x00),
+	JADARD_DCS(0xCC, 0x31),
+	JADARD_DCS(0xB2, 0x01, 0x23, 0x60, 0x88, 0x24, 0x5A, 0x07),
+	JADARD_DCS(0xBB, 0x02, 0x1A, 0x33, 0x5A, 0x3C, 0x44, 0x44),
+	JADARD_DCS(0xBD, 0x00, 0xD0, 0x00),
+	JADARD_DCS(0xBF, 0x50, 0x3C, 0x33, 0xC3),
+	JADARD_DCS(0xC0, 0x01, 0xAD, 0x01, 0xAD),
+	JADARD_DCS(0xCB, 0x7F, 0x7A, 0x75, 0x6C, 0x63, 0x64, 0x57, 0x5C, 0x46,
+		   0x5C, 0x57, 0x53, 0x6B, 0x54, 0x56, 0x44, 0x3E, 0x2F, 0x1D,
+		   0x14, 0x10, 0x7F, 0x7A, 0x75, 0x6C, 0x63, 0x64, 0x57, 0x5C,
+		   0x46, 0x5C, 0x57, 0x53, 0x6B, 0x54, 0x56, 0x44, 0x3E, 0x2F,
+		   0x1D, 0x14, 0x10, 0x00),
+	JADARD_DCS(0xC3, 0x3B, 0x01, 0x00, 0x03, 0x08, 0x08, 0x4C, 0x05, 0x4E,
+		   0x05, 0x4E, 0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A,
+		   0x06, 0x09, 0x06, 0x09, 0x06, 0x09),
+	JADARD_DCS(0xC4, 0x01, 0x00, 0x03, 0x08, 0x08, 0x4C, 0x05, 0x4E, 0x05,
+		   0x4E, 0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A, 0x06,
+		   0x09, 0x06, 0x09, 0x06, 0x09),
+	JADARD_DCS(0xC5, 0x03, 0x03, 0x08, 0x08, 0x4C, 0x05, 0x4E, 0x05, 0x4E,
+		   0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A, 0x06, 0x09,
+		   0x06, 0x09, 0x06, 0x09),
+	JADARD_DCS(0xC6, 0x00, 0x59, 0x00, 0xB4, 0x00, 0x13, 0x28, 0x82, 0x00,
+		   0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x01, 0x00, 0x00, 0x01),
+	JADARD_DCS(0xC8, 0x2B, 0x1C, 0x78),
+	JADARD_DCS(0xCD, 0x06, 0x02),
+	JADARD_DCS(0xCE, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
+		   0x0C, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xCF, 0x00, 0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+		   0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+		   0xFF, 0x3F),
+	JADARD_DCS(0xD0, 0x00, 0x1F, 0x1F, 0x11, 0x24, 0x24, 0x0B, 0x09, 0x07,
+		   0x05, 0x01, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xD1, 0x00, 0x1F, 0x1F, 0x10, 0x24, 0x24, 0x0A, 0x08, 0x06,
+		   0x04, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xD2, 0x00, 0x1F, 0x1F, 0x00, 0x24, 0x24, 0x08, 0x0A, 0x04,
+		   0x06, 0x10, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F),
+	JADARD_DCS(0xD3, 0x00, 0x1F, 0x1F, 0x00, 0x24, 0x24, 0x09, 0x0B, 0x05,
+		   0x07, 0x11, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+		   0x1F, 0x1F, 0x1F, 0x1F),
+	JADARD_DCS(0xD4, 0x00, 0x20, 0x0C, 0x00, 0x0A, 0x00, 0x0C, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x03,
+		   0x03, 0x00, 0x81, 0x04, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x80, 0x09, 0x00, 0x0A, 0x06, 0x55, 0x06, 0x0D,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00),
+	JADARD_DCS(0xD5, 0x02, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0xE0, 0x00, 0x00, 0x00, 0x07, 0x32, 0x5A, 0x00, 0x00, 0x05,
+		   0x00, 0x01, 0x00, 0x30, 0x74, 0x00, 0x0E, 0x00, 0x08, 0x00,
+		   0x71, 0x20, 0x04, 0x10, 0x04, 0x06, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x1F, 0xFF,
+		   0x00, 0x00, 0x00, 0x1F, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+		   0xFF, 0xFF, 0x00),
+	JADARD_DCS(0xD7, 0x00, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34,
+		   0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34),
+	JADARD_PAGE(0x01),
+	JADARD_DCS(0xB9, 0x00, 0xFF, 0xFF, 0x04),
+	JADARD_DCS(0xC7, 0x1B, 0x14, 0x0E),
+	JADARD_PAGE(0x02),
+	JADARD_DCS(0xBB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x68, 0x69),
+	JADARD_DCS(0xBD, 0x1B),
+	JADARD_DCS(0xC1, 0x00, 0x40, 0x00, 0x02, 0x02, 0x02, 0x02, 0x7F, 0x00,
+		   0x00, 0x00, 0x00),
+	JADARD_DCS(0xC3, 0x20, 0xFF),
+	JADARD_DCS(0xC4, 0x00, 0x11, 0x07, 0x00, 0x02),
+	JADARD_DCS(0xC6, 0x49, 0x00),
+	JADARD_DCS(0xE5, 0x00, 0xE6, 0xE5, 0x02, 0x27, 0x42, 0x27, 0x42, 0x09,
+		   0x04, 0x00, 0x40, 0x00, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00,
+		   0x00, 0x00, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xE6, 0x10, 0x09, 0xAD, 0x00, 0x00, 0x00),
+	JADARD_DCS(0xEC, 0x07, 0x07, 0x40, 0x00, 0x22, 0x02, 0x00, 0xFF, 0x08,
+		   0x7C, 0x00, 0x00, 0x00, 0x00),
+	JADARD_PAGE(0x03),
+	JADARD_DCS(0xD1, 0x00, 0x00, 0x21, 0xFF, 0x00),
+	JADARD_PAGE(0x00),
+	JADARD_DCS(MIPI_DCS_SET_TEAR_ON, MIPI_DSI_DCS_TEAR_MODE_VBLANK),
+	JADARD_DELAY(30),
+};
+
+/* Marks the start of the init traffic for the analyser */
+static void jadard_dbg_trigger(struct jadard *jadard)
+{
+	gpiod_set_value(jadard->dbg, 1);
+	usleep_range(1000, 2000);
+	gpiod_set_value(jadard->dbg, 0);
+
+	// In case we won't see communication after above gpio trigger,
+	// to make sure we capturing right packet
+	if (complex_dbg_pattern) {
+		usleep_range(1000, 2000);
+		gpiod_set_value(jadard->dbg, 1);
+		usleep_range(1000, 2000);
+		gpiod_set_value(jadard->dbg, 0);
+	}
+}
+
+static int shenzen_z34014_p30_365t_y1_init_cmds(struct jadard *jadard)
+{
+	int ret;
+
+	if (static_branch_unlikely(&jadard_dbg) && jadard->dbg)
+		jadard_dbg_trigger(jadard);
+
+	ret = jadard_send_init_table(jadard, &jadard->init_table);
+	if (ret)
+		dev_err(&jadard->dsi->dev, "MIPI init code error: %d\n", ret);
+
+	return ret;
+}
+
+/*
+ * Horizontal timing, VSYNC, VBP and physical size are the manufacturer's.
+ * The manufacturer's 60 Hz mode uses a 180 line VFP, lower refresh rates
+ * scale the pixel clock down and the reduced blanking mode trims VFP.
+ */
+#define SHENZEN_Z34014_P30_365T_Y1_CLOCK(vfp, refresh)			\
+	((480 + 20 + 20 + 40) * (1080 + (vfp) + 2 + 18) * (refresh) / 1000)
+
+#define SHENZEN_Z34014_P30_365T_Y1_MODE(pixel_clock, vfp, mode_type) {	\
+	.clock	= (pixel_clock),					\
+									\
+	/* Horizontal timing (from manufacturer) */			\
+	.hdisplay = 480,						\
+	.hsync_start = 480 + 20,	/* 500 (hdisplay + HFP) */	\
+	.hsync_end = 480 + 20 + 20,	/* 520 (+ HSYNC width) */	\
+	.htotal = 480 + 20 + 20 + 40,	/* 560 (+ HBP) */		\
+									\
+	/* Vertical timing */						\
+	.vdisplay = 1080,						\
+	.vsync_start = 1080 + (vfp),	/* vdisplay + VFP */		\
+	.vsync_end = 1080 + (vfp) + 2,	/* + VSYNC width */		\
+	.vtotal = 1080 + (vfp) + 2 + 18, /* + VBP */			\
+									\
+	/* Physical dimensions (from manufacturer) */			\
+	.width_mm = 42,		/* 42.0mm width */			\
+	.height_mm = 95,	/* 94.5mm height (rounded) */		\
+	.type = DRM_MODE_TYPE_DRIVER | (mode_type),			\
+}
+
+static const struct drm_display_mode shenzen_z34014_p30_365t_y1_modes[] = {
+	SHENZEN_Z34014_P30_365T_Y1_MODE(SHENZEN_Z34014_P30_365T_Y1_CLOCK(180, 60),
+					180, DRM_MODE_TYPE_PREFERRED),
+	SHENZEN_Z34014_P30_365T_Y1_MODE(SHENZEN_Z34014_P30_365T_Y1_CLOCK(20, 60),
+					20, 0),
+	SHENZEN_Z34014_P30_365T_Y1_MODE(SHENZEN_Z34014_P30_365T_Y1_CLOCK(180, 48),
+					180, 0),
+	SHENZEN_Z34014_P30_365T_Y1_MODE(SHENZEN_Z34014_P30_365T_Y1_CLOCK(180, 30),
+					180, 0),
+	/*
+	 * Preferred pixel clock with only VFP stretched, vtotal 1536 gives 50 Hz
+	 * and 1920 gives 40 Hz. A host that retimes its front porch on the fly
+	 * switches between these and 60 Hz without a modeset. The controller
+	 * follows the incoming sync in video mode, 0xB2/0xBB stay as they are.
+	 */
+	SHENZEN_Z34014_P30_365T_Y1_MODE(SHENZEN_Z34014_P30_365T_Y1_CLOCK(180, 60),
+					436, 0),
+	SHENZEN_Z34014_P30_365T_Y1_MODE(SHENZEN_Z34014_P30_365T_Y1_CLOCK(180, 60),
+					820, 0),
+};
+
+static const struct jadard_reg_id shenzen_z34014_p30_365t_y1_colour_regs[] = {
+	{ .page = 0x00, .cmd = 0xcb },
+	{ .page = 0x01, .cmd = 0xc7 },
+};
+
+static const struct jadard_panel_desc shenzen_z34014_p30_365t_y1_desc = {
+	.chip = &jd9365tn_chip,
+	.modes = shenzen_z34014_p30_365t_y1_modes,
+	.num_modes = ARRAY_SIZE(shenzen_z34014_p30_365t_y1_modes),
+	.max_lane_rate_mbps = 1000,
+	.lanes = 2,
+	.format = MIPI_DSI_FMT_RGB888,
+	/* The manufacturer's init code only covers 2 lane operation */
+	.lanes_mask = BIT(2),
+	.formats_mask = BIT(MIPI_DSI_FMT_RGB888) | BIT(MIPI_DSI_FMT_RGB666) |
+			BIT(MIPI_DSI_FMT_RGB666_PACKED) | BIT(MIPI_DSI_FMT_RGB565),
+	.timings = {
+		.reset_low_us = 5000,
+		.reset_pulse_us = 10000,
+		.reset_to_init_us = 130000,
+		.sleep_out_us = 120000,
+		.display_on_us = 10000,
+		.reset_down_to_power_off_us = 120000,
+		.reset_up_to_power_off_us = 1000,
+	},
+	/* Rails, reset and sleep out alone account for about 300 ms */
+	.prepare_budget_us = 400000,
+	.init = shenzen_z34014_p30_365t_y1_init_cmds,
+	.init_table = JADARD_INIT_TABLE(shenzen_z34014_p30_365t_y1_init_table),
+	.firmware = "jadard/z34014p30365ty1.bin",
+	.init_in_hs_mode = true,
+	.command_mode = true,
+	.colour_regs = shenzen_z34014_p30_365t_y1_colour_regs,
+	.num_colour_regs = ARRAY_SIZE(shenzen_z34014_p30_365t_y1_colour_regs),
+	.scan_flip = true,
+	.signature_page = 0x00,
+	.signature_reg = 0xcc,
+	.signature = 0x31,
+	.max_brightness = 255,
+	.dimming = true,
+	.cabc = JADARD_CABC_UI,
 };
 
-#define JD9365DA_DCS_SWITCH_PAGE	0xe0
+static int jadard_phase_stats_show(struct seq_file *m, void *data)
+{
+	struct jadard *jadard = m->private;
+	int i;
+
+	seq_printf(m, "%-12s %8s %10s %10s %10s %10s\n", "phase", "count",
+		   "min_us", "avg_us", "max_us", "last_us");
 
-#define jd9365da_switch_page(dsi_ctx, page) \
-	mipi_dsi_dcs_write_seq_multi(dsi_ctx, JD9365DA_DCS_SWITCH_PAGE, (page))
+	mutex_lock(&jadard->stats_lock);
+	for (i = 0; i < JADARD_PHASE_COUNT; i++) {
+		const struct jadard_phase_stats *stats = &jadard->stats[i];
 
-static inline struct jadard *panel_to_jadard(struct drm_panel *panel)
+		seq_printf(m, "%-12s %8llu %10lld %10lld %10lld %10lld\n",
+			   jadard_phase_names[i], stats->count, stats->min_us,
+			   stats->count ? div64_s64(stats->total_us, stats->count) : 0,
+			   stats->max_us, stats->last_us);
+	}
+	mutex_unlock(&jadard->stats_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(jadard_phase_stats);
+
+static int jadard_te_stats_show(struct seq_file *m, void *data)
 {
-	return container_of(panel, struct jadard, panel);
+	struct jadard *jadard = m->private;
+	unsigned long flags;
+	s64 period_us;
+	ktime_t last;
+	u64 count;
+
+	spin_lock_irqsave(&jadard->te_lock, flags);
+	count = jadard->te_count;
+	last = jadard->te_last;
+	period_us = jadard->te_period_us;
+	spin_unlock_irqrestore(&jadard->te_lock, flags);
+
+	seq_printf(m, "count: %llu\n", count);
+	seq_printf(m, "last_ns: %lld\n", ktime_to_ns(last));
+	seq_printf(m, "period_us: %lld\n", period_us);
+
+	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(jadard_te_stats);
 
-static int jadard_disable(struct drm_panel *panel)
+static int jadard_shadow_show(struct seq_file *m, void *data)
 {
-	struct jadard *jadard = panel_to_jadard(panel);
-	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	struct jadard *jadard = m->private;
+	unsigned int i, j;
 
-	if (jadard->desc->backlight_off_to_display_off_delay_ms)
-		mipi_dsi_msleep(&dsi_ctx, jadard->desc->backlight_off_to_display_off_delay_ms);
+	seq_printf(m, "valid: %d\n", jadard->shadow_valid);
 
-	mipi_dsi_dcs_set_display_off_multi(&dsi_ctx);
+	for (i = 0; i < jadard->num_shadow; i++) {
+		const struct jadard_shadow_reg *reg = &jadard->shadow[i];
 
-	if (jadard->desc->display_off_to_enter_sleep_delay_ms)
-		mipi_dsi_msleep(&dsi_ctx, jadard->desc->display_off_to_enter_sleep_delay_ms);
+		seq_printf(m, "page %02x reg %02x:", reg->page, reg->data[0]);
+		for (j = 1; j < reg->len; j++)
+			seq_printf(m, " %02x", reg->data[j]);
+		seq_puts(m, "\n");
+	}
 
-	mipi_dsi_dcs_enter_sleep_mode_multi(&dsi_ctx);
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(jadard_shadow);
 
-	if (jadard->desc->enter_sleep_to_reset_down_delay_ms)
-		mipi_dsi_msleep(&dsi_ctx, jadard->desc->enter_sleep_to_reset_down_delay_ms);
+static int jadard_esd_stats_show(struct seq_file *m, void *data)
+{
+	struct jadard *jadard = m->private;
 
-	return dsi_ctx.accum_err;
+	seq_printf(m, "interval_ms: %u\n", jadard->esd_interval_ms);
+	seq_printf(m, "checks: %llu\n", jadard->esd_checks);
+	seq_printf(m, "failures: %llu\n", jadard->esd_failures);
+	seq_printf(m, "recoveries: %llu\n", jadard->esd_recoveries);
+
+	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(jadard_esd_stats);
 
-static int jadard_prepare(struct drm_panel *panel)
+static int jadard_link_stats_show(struct seq_file *m, void *data)
+{
+	struct jadard *jadard = m->private;
+	const struct jadard_link_stats *link = &jadard->link;
+	const struct jadard_link_stats *last = &jadard->last_prepare;
+
+	seq_printf(m, "%-12s %10s %10s %12s\n", "", "packets", "bytes",
+		   "sleep_us");
+	seq_printf(m, "%-12s %10llu %10llu %12llu\n", "total",
+		   link->packets, link->bytes, link->sleep_us);
+	seq_printf(m, "%-12s %10llu %10llu %12llu\n", "last_prepare",
+		   last->packets, last->bytes, last->sleep_us);
+	seq_printf(m, "last_prepare_us: %lld\n", jadard->last_prepare_us);
+	seq_printf(m, "prepare_budget_us: %u\n",
+		   jadard->desc->prepare_budget_us);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(jadard_link_stats);
+
+static void jadard_debugfs_init(struct drm_panel *panel, struct dentry *root)
 {
 	struct jadard *jadard = panel_to_jadard(panel);
-	int ret;
 
-	gpiod_set_value(jadard->vccio, 1);
-	gpiod_set_value(jadard->vdd, 1);
+	debugfs_create_file("phase_stats", 0444, root, jadard,
+			    &jadard_phase_stats_fops);
+	debugfs_create_file("link_stats", 0444, root, jadard,
+			    &jadard_link_stats_fops);
+	debugfs_create_file("registers", 0444, root, jadard,
+			    &jadard_shadow_fops);
+	debugfs_create_file("esd_stats", 0444, root, jadard,
+			    &jadard_esd_stats_fops);
+
+	if (jadard->te)
+		debugfs_create_file("te_stats", 0444, root, jadard,
+				    &jadard_te_stats_fops);
+}
 
-	if (jadard->desc->vcioo_to_lp11_delay_ms)
-		msleep(jadard->desc->vcioo_to_lp11_delay_ms);
+static const struct drm_panel_funcs jadard_funcs = {
+	.disable = jadard_disable,
+	.unprepare = jadard_unprepare,
+	.prepare = jadard_prepare,
+	.get_modes = jadard_get_modes,
+	.get_orientation = jadard_panel_get_orientation,
+	.debugfs_init = jadard_debugfs_init,
+};
 
-	if (jadard->desc->lp11_before_reset) {
-		ret = mipi_dsi_dcs_nop(jadard->dsi);
-		if (ret)
-			return ret;
+/* A table has to write at least one register, only pages and delays won't do */
+static bool jadard_init_table_valid(const u8 *data, size_t len)
+{
+	unsigned int n = 0;
+	size_t i = 0;
+
+	while (i < len) {
+		if (i + 1 >= len)
+			return false;
+
+		switch (data[i]) {
+		case JADARD_OP_DCS:
+			if (!data[i + 1] || i + 2 + data[i + 1] > len)
+				return false;
+			n++;
+			break;
+		case JADARD_OP_PAGE:
+		case JADARD_OP_DELAY:
+			break;
+		default:
+			return false;
+		}
+
+		i += jadard_entry_len(&data[i]);
 	}
 
-	if (jadard->desc->lp11_to_reset_delay_ms)
-		msleep(jadard->desc->lp11_to_reset_delay_ms);
+	return n;
+}
+
+static void jadard_release_firmware(void *data)
+{
+	release_firmware(data);
+}
 
-	gpiod_set_value(jadard->reset, 0);
-	msleep(5);
+static void jadard_release_colour(void *data)
+{
+	struct jadard *jadard = data;
 
-	gpiod_set_value(jadard->reset, 1);
-	msleep(10);
+	release_firmware(jadard->colour_fw);
+}
 
-	gpiod_set_value(jadard->reset, 0);
-	msleep(130);
+/*
+ * Init blobs use the same packed format as the built-in tables and are sent
+ * straight out of the firmware buffer, which is kept for the device lifetime.
+ */
+static int jadard_load_init_table(struct jadard *jadard)
+{
+	struct device *dev = &jadard->dsi->dev;
+	const char *name = jadard->desc->firmware;
+	int ret;
+
+	jadard->init_table = jadard->desc->init_table;
+
+	of_property_read_string(dev->of_node, "firmware-name", &name);
+	if (!name)
+		return 0;
+
+	ret = firmware_request_nowarn(&jadard->fw, name, dev);
+	if (ret) {
+		dev_dbg(dev, "no init blob %s, using built-in table\n", name);
+		return 0;
+	}
 
-	ret = jadard->desc->init(jadard);
+	ret = devm_add_action_or_reset(dev, jadard_release_firmware,
+				       (void *)jadard->fw);
 	if (ret)
 		return ret;
 
+	if (!jadard_init_table_valid(jadard->fw->data, jadard->fw->size)) {
+		dev_warn(dev, "malformed init blob %s, using built-in table\n",
+			 name);
+		return 0;
+	}
+
+	dev_info(dev, "using init blob %s (%zu bytes)\n", name,
+		 jadard->fw->size);
+	jadard->init_table.data = jadard->fw->data;
+	jadard->init_table.len = jadard->fw->size;
+
 	return 0;
 }
 
-static int jadard_unprepare(struct drm_panel *panel)
+static int jadard_bl_update_status(struct backlight_device *bl)
 {
-	struct jadard *jadard = panel_to_jadard(panel);
-
-	gpiod_set_value(jadard->reset, 0);
-	msleep(120);
+	struct jadard *jadard = bl_get_data(bl);
+	struct device *dev = &jadard->dsi->dev;
+	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
 
-	if (jadard->desc->reset_before_power_off_vcioo) {
-		gpiod_set_value(jadard->reset, 1);
+	mutex_lock(&jadard->reg_lock);
 
-		usleep_range(1000, 2000);
+	/* A powered down panel picks the level up at the next init */
+	if (pm_runtime_get_if_in_use(dev) > 0) {
+		jadard_set_brightness_multi(&dsi_ctx,
+					    backlight_get_brightness(bl));
+		pm_runtime_put(dev);
 	}
 
-	gpiod_set_value(jadard->vdd, 0);
-	gpiod_set_value(jadard->vccio, 0);
+	mutex_unlock(&jadard->reg_lock);
 
-	return 0;
+	return dsi_ctx.accum_err;
 }
 
-static int jadard_get_modes(struct drm_panel *panel,
-			    struct drm_connector *connector)
+static const struct backlight_ops jadard_bl_ops = {
+	.update_status = jadard_bl_update_status,
+};
+
+static ssize_t idle_show(struct device *dev, struct device_attribute *attr,
+			 char *buf)
 {
-	struct jadard *jadard = panel_to_jadard(panel);
-	const struct drm_display_mode *desc_mode = &jadard->desc->mode;
-	struct drm_display_mode *mode;
+	struct jadard *jadard = dev_get_drvdata(dev);
 
-	mode = drm_mode_duplicate(connector->dev, desc_mode);
-	if (!mode) {
-		DRM_DEV_ERROR(&jadard->dsi->dev, "failed to add mode %ux%ux@%u\n",
-			      desc_mode->hdisplay, desc_mode->vdisplay,
-			      drm_mode_vrefresh(desc_mode));
-		return -ENOMEM;
-	}
+	return sysfs_emit(buf, "%d\n", jadard->idle);
+}
+
+/*
+ * Switching idle mode is a single DCS write, the panel stays prepared and
+ * keeps scanning out. An unpowered panel enters it at the next init.
+ */
+static ssize_t idle_store(struct device *dev, struct device_attribute *attr,
+			  const char *buf, size_t count)
+{
+	struct jadard *jadard = dev_get_drvdata(dev);
+	bool idle;
+	int ret;
+
+	ret = kstrtobool(buf, &idle);
+	if (ret)
+		return ret;
 
-	drm_mode_set_name(mode);
-	drm_mode_probed_add(connector, mode);
+	mutex_lock(&jadard->reg_lock);
 
-	connector->display_info.width_mm = mode->width_mm;
-	connector->display_info.height_mm = mode->height_mm;
+	jadard->idle = idle;
 
-	return 1;
+	if (pm_runtime_get_if_in_use(dev) > 0) {
+		ret = jadard_send_idle(jadard);
+		pm_runtime_put(dev);
+	}
+
+	mutex_unlock(&jadard->reg_lock);
+
+	return ret ?: count;
 }
+static DEVICE_ATTR_RW(idle);
 
-static enum drm_panel_orientation jadard_panel_get_orientation(struct drm_panel *panel)
+/* Colour tables may only hold writes to the descriptor's colour registers */
+static bool jadard_colour_table_valid(struct jadard *jadard, const u8 *data,
+				      size_t len)
 {
-	struct jadard *jadard = panel_to_jadard(panel);
+	const struct jadard_panel_desc *desc = jadard->desc;
+	struct jadard_shadow_reg *reg;
+	unsigned int j;
+	int page = -1;
+	size_t i;
+
+	if (!jadard_init_table_valid(data, len))
+		return false;
+
+	for (i = 0; i < len; i += jadard_entry_len(&data[i])) {
+		if (data[i] == JADARD_OP_PAGE)
+			page = data[i + 1];
+
+		if (data[i] != JADARD_OP_DCS)
+			continue;
+
+		for (j = 0; j < desc->num_colour_regs; j++)
+			if (desc->colour_regs[j].page == page &&
+			    desc->colour_regs[j].cmd == data[i + 2])
+				break;
+
+		reg = jadard_shadow_find(jadard, page, data[i + 2]);
+		if (j == desc->num_colour_regs || !reg ||
+		    reg->len != data[i + 1])
+			return false;
+	}
 
-	return jadard->orientation;
+	return true;
 }
 
-static int complex_dbg_pattern=0;
-module_param(complex_dbg_pattern,int,0660);
-
-static int shenzen_z34014_p30_365t_y1_init_cmds(struct jadard *jadard)
+/*
+ * Takes the name of a blob under /lib/firmware in the init table format.
+ * Registers that differ from what the panel holds are written right away
+ * and the table is applied again after each init.
+ */
+static ssize_t colour_table_store(struct device *dev,
+				  struct device_attribute *attr,
+				  const char *buf, size_t count)
 {
-	pr_info("Jadard init start sending\n");
+	struct jadard *jadard = dev_get_drvdata(dev);
+	const struct firmware *fw;
+	char *name;
+	int ret;
 
-	pr_info("Triggering DBG GPIO for testing\n");
-	gpiod_set_value(jadard->dbg, 1);
-	usleep_range(1000, 2000);
-	gpiod_set_value(jadard->dbg, 0);
+	name = kstrndup(buf, count, GFP_KERNEL);
+	if (!name)
+		return -ENOMEM;
 
-	// In case we won't see communication after above gpio trigger,
-	// to make sure we capturing right packet
-	pr_info("Jadard complex_dbg_pattern: %d\n", complex_dbg_pattern);
-	if (complex_dbg_pattern) {
-		pr_info("Jadard execute extra gpio triggering\n");
-		usleep_range(1000, 2000);
-		gpiod_set_value(jadard->dbg, 1);
-		usleep_range(1000, 2000);
-		gpiod_set_value(jadard->dbg, 0);
-	}
+	ret = request_firmware(&fw, strim(name), dev);
+	kfree(name);
+	if (ret)
+		return ret;
 
-	/*
-	 * https://regexr.com/
-	 *
-	 * Used regex to convert for manufacturer's init code
-	 *	{(0x..),.[1-9]+,.{(.+)}},
-	 *
-	 * With replaced value:
-	 *	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, $1, $2);
-	 *
-	 * And then run ClangFormat
-	 *
-	 */
+	if (!jadard_colour_table_valid(jadard, fw->data, fw->size)) {
+		release_firmware(fw);
+		return -EINVAL;
+	}
 
-	struct mipi_dsi_multi_context dsi_ctx = { .dsi = jadard->dsi };
+	mutex_lock(&jadard->reg_lock);
 
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xDF, 0x90, 0x69, 0xF9);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xDE, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xCC, 0x31);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xB2, 0x01, 0x23, 0x60, 0x88,
-				     0x24, 0x5A, 0x07);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xBB, 0x02, 0x1A, 0x33, 0x5A,
-				     0x3C, 0x44, 0x44);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xBD, 0x00, 0xD0, 0x00);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xBF, 0x50, 0x3C, 0x33, 0xC3);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC0, 0x01, 0xAD, 0x01, 0xAD);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xCB, 0x7F, 0x7A, 0x75, 0x6C,
-				     0x63, 0x64, 0x57, 0x5C, 0x46, 0x5C, 0x57,
-				     0x53, 0x6B, 0x54, 0x56, 0x44, 0x3E, 0x2F,
-				     0x1D, 0x14, 0x10, 0x7F, 0x7A, 0x75, 0x6C,
-				     0x63, 0x64, 0x57, 0x5C, 0x46, 0x5C, 0x57,
-				     0x53, 0x6B, 0x54, 0x56, 0x44, 0x3E, 0x2F,
-				     0x1D, 0x14, 0x10, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC3, 0x3B, 0x01, 0x00, 0x03,
-				     0x08, 0x08, 0x4C, 0x05, 0x4E, 0x05, 0x4E,
-				     0x01, 0x48, 0x01, 0x48, 0x01, 0x48, 0x06,
-				     0x4A, 0x06, 0x09, 0x06, 0x09, 0x06, 0x09);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC4, 0x01, 0x00, 0x03, 0x08,
-				     0x08, 0x4C, 0x05, 0x4E, 0x05, 0x4E, 0x01,
-				     0x48, 0x01, 0x48, 0x01, 0x48, 0x06, 0x4A,
-				     0x06, 0x09, 0x06, 0x09, 0x06, 0x09);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC5, 0x03, 0x03, 0x08, 0x08,
-				     0x4C, 0x05, 0x4E, 0x05, 0x4E, 0x01, 0x48,
-				     0x01, 0x48, 0x01, 0x48, 0x06, 0x4A, 0x06,
-				     0x09, 0x06, 0x09, 0x06, 0x09);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC6, 0x00, 0x59, 0x00, 0xB4,
-				     0x00, 0x13, 0x28, 0x82, 0x00, 0x00, 0x00,
-				     0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x01, 0x00, 0x00, 0x01);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC8, 0x2B, 0x1C, 0x78);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xCD, 0x06, 0x02);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xCE, 0x00, 0x00, 0x00, 0x0C,
-				     0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xCF, 0x00, 0x00, 0x00, 0x30,
-				     0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
-				     0xFF, 0xFF, 0xFF, 0xFF, 0x3F);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xD0, 0x00, 0x1F, 0x1F, 0x11,
-				     0x24, 0x24, 0x0B, 0x09, 0x07, 0x05, 0x01,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xD1, 0x00, 0x1F, 0x1F, 0x10,
-				     0x24, 0x24, 0x0A, 0x08, 0x06, 0x04, 0x00,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xD2, 0x00, 0x1F, 0x1F, 0x00,
-				     0x24, 0x24, 0x08, 0x0A, 0x04, 0x06, 0x10,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xD3, 0x00, 0x1F, 0x1F, 0x00,
-				     0x24, 0x24, 0x09, 0x0B, 0x05, 0x07, 0x11,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
-				     0x1F, 0x1F, 0x1F, 0x1F, 0x1F);
-
-	mipi_dsi_dcs_write_seq_multi(
-		&dsi_ctx, 0xD4, 0x00, 0x20, 0x0C, 0x00, 0x0A, 0x00, 0x0C, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06,
-		0x03, 0x03, 0x00, 0x81, 0x04, 0x4C, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x80, 0x09, 0x00, 0x0A, 0x06, 0x55, 0x06,
-		0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00);
-
-	mipi_dsi_dcs_write_seq_multi(
-		&dsi_ctx, 0xD5, 0x02, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0xE0, 0x00, 0x00, 0x00, 0x07, 0x32, 0x5A, 0x00, 0x00,
-		0x05, 0x00, 0x01, 0x00, 0x30, 0x74, 0x00, 0x0E, 0x00, 0x08,
-		0x00, 0x71, 0x20, 0x04, 0x10, 0x04, 0x06, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x1F,
-		0xFF, 0x00, 0x00, 0x00, 0x1F, 0xFF, 0x00, 0xFF, 0xFF, 0xFF,
-		0xFF, 0xFF, 0xFF, 0x00);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xD7, 0x00, 0x34, 0x34, 0x34,
-				     0x34, 0x34, 0x34, 0x34, 0x34, 0x34, 0x34,
-				     0x34, 0x34, 0x34, 0x34, 0x34, 0x34);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xDE, 0x01);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xB9, 0x00, 0xFF, 0xFF, 0x04);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC7, 0x1B, 0x14, 0x0E);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xDE, 0x02);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xBB, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x68, 0x69);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xBD, 0x1B);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC1, 0x00, 0x40, 0x00, 0x02,
-				     0x02, 0x02, 0x02, 0x7F, 0x00, 0x00, 0x00,
-				     0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC3, 0x20, 0xFF);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC4, 0x00, 0x11, 0x07, 0x00,
-				     0x02);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xC6, 0x49, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xE5, 0x00, 0xE6, 0xE5, 0x02,
-				     0x27, 0x42, 0x27, 0x42, 0x09, 0x04, 0x00,
-				     0x40, 0x00, 0x21, 0x00, 0x00, 0x00, 0x00,
-				     0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
-
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xE6, 0x10, 0x09, 0xAD, 0x00,
-				     0x00, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xEC, 0x07, 0x07, 0x40, 0x00,
-				     0x22, 0x02, 0x00, 0xFF, 0x08, 0x7C, 0x00,
-				     0x00, 0x00, 0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xDE, 0x03);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xD1, 0x00, 0x00, 0x21, 0xFF,
-				     0x00);
-	mipi_dsi_dcs_write_seq_multi(&dsi_ctx, 0xDE, 0x00);
-
-
-	mipi_dsi_dcs_set_tear_on_multi(&dsi_ctx, MIPI_DSI_DCS_TEAR_MODE_VBLANK);
-	mipi_dsi_msleep(&dsi_ctx, 30);
-
-	mipi_dsi_dcs_exit_sleep_mode_multi(&dsi_ctx);
-	mipi_dsi_msleep(&dsi_ctx, 120);
-
-	mipi_dsi_dcs_set_display_on_multi(&dsi_ctx);
-	mipi_dsi_msleep(&dsi_ctx, 10);
+	release_firmware(jadard->colour_fw);
+	jadard->colour_fw = fw;
+	jadard->colour.data = fw->data;
+	jadard->colour.len = fw->size;
 
-	if (dsi_ctx.accum_err)
-		pr_err("MIPI init code error!\n");
+	if (jadard->initialized && pm_runtime_get_if_in_use(dev) > 0) {
+		ret = jadard_write_table_delta(jadard, &jadard->colour);
+		pm_runtime_put(dev);
+	}
 
-	pr_info("Jadard init finished\n");
+	mutex_unlock(&jadard->reg_lock);
 
-	return dsi_ctx.accum_err;
+	return ret ?: count;
 }
+static DEVICE_ATTR_WO(colour_table);
 
-static const struct jadard_panel_desc shenzen_z34014_p30_365t_y1_desc = {
-	.mode = {
-		.clock	= (480 + 20 + 20 + 40) * (1080 + 180 + 2 + 18) * 60 / 1000,
-
-		// Horizontal timing (from manufacturer)
-		.hdisplay = 480,
-		.hsync_start = 480 + 20,        // 500 (hdisplay + HFP)
-		.hsync_end = 480 + 20 + 20,     // 520 (+ HSYNC width)
-		.htotal = 480 + 20 + 20 + 40,   // 560 (+ HBP)
-
-		// Vertical timing (from manufacturer)
-		.vdisplay = 1080,
-		.vsync_start = 1080 + 180,      // 1260 (vdisplay + VFP)
-		.vsync_end = 1080 + 180 + 2,    // 1262 (+ VSYNC width)
-		.vtotal = 1080 + 180 + 2 + 18,  // 1280 (+ VBP)
-
-		// Physical dimensions (from manufacturer)
-		.width_mm = 42,   // 42.0mm width
-		.height_mm = 95,  // 94.5mm height (rounded)
-		.type = DRM_MODE_TYPE_DRIVER | DRM_MODE_TYPE_PREFERRED,
-	},
-	.lanes = 2,
-	.format = MIPI_DSI_FMT_RGB888,
-	.init = shenzen_z34014_p30_365t_y1_init_cmds,
+static struct attribute *jadard_attrs[] = {
+	&dev_attr_idle.attr,
+	&dev_attr_colour_table.attr,
+	NULL
 };
+ATTRIBUTE_GROUPS(jadard);
 
-static const struct drm_panel_funcs jadard_funcs = {
-	.disable = jadard_disable,
-	.unprepare = jadard_unprepare,
-	.prepare = jadard_prepare,
-	.get_modes = jadard_get_modes,
-	.get_orientation = jadard_panel_get_orientation,
+static const char * const jadard_cabc_names[] = {
+	[JADARD_CABC_OFF] = "off",
+	[JADARD_CABC_UI] = "ui",
+	[JADARD_CABC_STILL] = "still",
+	[JADARD_CABC_MOVING] = "moving",
+};
+
+static int jadard_dcs_backlight_register(struct jadard *jadard)
+{
+	struct device *dev = &jadard->dsi->dev;
+	const struct backlight_properties props = {
+		.type = BACKLIGHT_RAW,
+		.brightness = jadard->desc->max_brightness,
+		.max_brightness = jadard->desc->max_brightness,
+	};
+	const char *name;
+	int ret;
+
+	if (jadard->panel.backlight || !jadard->desc->max_brightness)
+		return 0;
+
+	jadard->cabc = jadard->desc->cabc;
+	if (!of_property_read_string(dev->of_node, "jadard,cabc", &name)) {
+		ret = match_string(jadard_cabc_names,
+				   ARRAY_SIZE(jadard_cabc_names), name);
+		if (ret < 0)
+			return dev_err_probe(dev, ret, "unknown CABC mode %s\n",
+					     name);
+
+		jadard->cabc = ret;
+	}
+
+	jadard->dcs_bl = devm_backlight_device_register(dev, dev_name(dev), dev,
+							 jadard, &jadard_bl_ops,
+							 &props);
+	if (IS_ERR(jadard->dcs_bl))
+		return dev_err_probe(dev, PTR_ERR(jadard->dcs_bl),
+				     "failed to register backlight\n");
+
+	jadard->panel.backlight = jadard->dcs_bl;
+
+	return 0;
+}
+
+static const char * const jadard_format_names[] = {
+	[MIPI_DSI_FMT_RGB888] = "rgb888",
+	[MIPI_DSI_FMT_RGB666] = "rgb666",
+	[MIPI_DSI_FMT_RGB666_PACKED] = "rgb666-packed",
+	[MIPI_DSI_FMT_RGB565] = "rgb565",
 };
 
+static int jadard_parse_link(struct mipi_dsi_device *dsi,
+			     const struct jadard_panel_desc *desc)
+{
+	struct device *dev = &dsi->dev;
+	const char *name;
+	int ret;
+
+	dsi->lanes = desc->lanes;
+	dsi->format = desc->format;
+
+	/* Lane count comes from data-lanes on the panel endpoint, if present */
+	ret = drm_of_get_data_lanes_count_ep(dev->of_node, 0, -1, 1,
+					     JADARD_MAX_LANES);
+	if (ret > 0)
+		dsi->lanes = ret;
+
+	if (!(desc->lanes_mask & BIT(dsi->lanes)))
+		return dev_err_probe(dev, -EINVAL, "%u data lanes not supported\n",
+				     dsi->lanes);
+
+	if (!of_property_read_string(dev->of_node, "jadard,pixel-format", &name)) {
+		ret = match_string(jadard_format_names,
+				   ARRAY_SIZE(jadard_format_names), name);
+		if (ret < 0)
+			return dev_err_probe(dev, ret, "unknown pixel format %s\n",
+					     name);
+
+		dsi->format = ret;
+	}
+
+	if (!(desc->formats_mask & BIT(dsi->format)))
+		return dev_err_probe(dev, -EINVAL, "pixel format %s not supported\n",
+				     jadard_format_names[dsi->format]);
+
+	return 0;
+}
+
 static int jadard_dsi_probe(struct mipi_dsi_device *dsi)
 {
 	struct device *dev = &dsi->dev;
 	const struct jadard_panel_desc *desc;
+	enum gpiod_flags reset_flags = GPIOD_OUT_HIGH;
+	enum gpiod_flags power_flags = GPIOD_OUT_LOW;
 	struct jadard *jadard;
+	bool handover, live;
 	int ret;
 
-	pr_info("Jadard driver starting probe!\n");
-
 	jadard = devm_kzalloc(&dsi->dev, sizeof(*jadard), GFP_KERNEL);
 	if (!jadard)
 		return -ENOMEM;
 
 	desc = of_device_get_match_data(dev);
-	dsi->mode_flags = MIPI_DSI_MODE_VIDEO | MIPI_DSI_MODE_VIDEO_BURST |
-			  MIPI_DSI_MODE_NO_EOT_PACKET | MIPI_DSI_MODE_LPM;
-	dsi->format = desc->format;
-	dsi->lanes = desc->lanes;
 
-	jadard->reset = devm_gpiod_get(dev, "reset", GPIOD_OUT_HIGH);
-	if (IS_ERR(jadard->reset)) {
-		DRM_DEV_ERROR(&dsi->dev, "failed to get our reset GPIO\n");
-		return PTR_ERR(jadard->reset);
-	}
+	/* Command mode lets the panel scan out of its own GRAM */
+	jadard->command_mode = desc->command_mode &&
+		of_property_read_bool(dev->of_node, "jadard,command-mode");
+	if (jadard->command_mode)
+		dsi->mode_flags = MIPI_DSI_MODE_NO_EOT_PACKET |
+				  MIPI_DSI_MODE_LPM;
+	else
+		dsi->mode_flags = MIPI_DSI_MODE_VIDEO |
+				  MIPI_DSI_MODE_VIDEO_BURST |
+				  MIPI_DSI_MODE_NO_EOT_PACKET |
+				  MIPI_DSI_MODE_LPM;
+
+	/* Boards may know better than the panel data, in both directions */
+	if (of_property_read_bool(dev->of_node, "jadard,non-continuous-clock") ||
+	    (desc->clock_non_continuous &&
+	     !of_property_read_bool(dev->of_node, "jadard,continuous-clock")))
+		dsi->mode_flags |= MIPI_DSI_CLOCK_NON_CONTINUOUS;
+
+	ret = jadard_parse_link(dsi, desc);
+	if (ret)
+		return ret;
 
-	/* VDD pin is connected to power regulator enable pin on adapter board */
-	jadard->vdd = devm_gpiod_get(dev, "vdd", GPIOD_OUT_LOW);
-	if (IS_ERR(jadard->vdd)) {
-		DRM_DEV_ERROR(&dsi->dev, "failed to get vdd GPIO\n");
-		return PTR_ERR(jadard->vdd);
+	/* Leave a panel set up by the bootloader alone until it's probed */
+	handover = of_property_read_bool(dev->of_node, "jadard,boot-handover");
+	if (handover) {
+		reset_flags = GPIOD_OUT_LOW;
+		power_flags = GPIOD_OUT_HIGH;
 	}
 
-	/* VCCIO pin is connected to power regulator enable pin on adapter board */
-	jadard->vccio = devm_gpiod_get(dev, "vccio", GPIOD_OUT_LOW);
-	if (IS_ERR(jadard->vccio)) {
-		DRM_DEV_ERROR(&dsi->dev, "failed to get vccio GPIO\n");
-		return PTR_ERR(jadard->vccio);
+	jadard->reset = devm_gpiod_get(dev, "reset", reset_flags);
+	if (IS_ERR(jadard->reset))
+		return dev_err_probe(dev, PTR_ERR(jadard->reset),
+				     "failed to get our reset GPIO\n");
+
+	/* Real supplies make the adapter board enable GPIOs optional */
+	jadard->use_supplies = of_property_present(dev->of_node, "vdd-supply") ||
+			       of_property_present(dev->of_node, "vccio-supply");
+	if (jadard->use_supplies) {
+		jadard->supplies[0].supply = "vccio";
+		jadard->supplies[1].supply = "vdd";
+		ret = devm_regulator_bulk_get(dev, ARRAY_SIZE(jadard->supplies),
+					      jadard->supplies);
+		if (ret)
+			return dev_err_probe(dev, ret, "failed to get supplies\n");
 	}
 
-	/* DBG pin is used for osciloscope debugging */
-	jadard->dbg = devm_gpiod_get(dev, "dbg", GPIOD_OUT_HIGH);
-	if (IS_ERR(jadard->dbg)) {
-		DRM_DEV_ERROR(&dsi->dev, "failed to get dbg GPIO\n");
-		return PTR_ERR(jadard->dbg);
+	/* VDD pin is connected to power regulator enable pin on adapter board */
+	if (jadard->use_supplies)
+		jadard->vdd = devm_gpiod_get_optional(dev, "vdd", power_flags);
+	else
+		jadard->vdd = devm_gpiod_get(dev, "vdd", power_flags);
+	if (IS_ERR(jadard->vdd))
+		return dev_err_probe(dev, PTR_ERR(jadard->vdd),
+				     "failed to get vdd GPIO\n");
+
+	/* VCCIO pin is connected to power regulator enable pin on adapter board */
+	if (jadard->use_supplies)
+		jadard->vccio = devm_gpiod_get_optional(dev, "vccio", power_flags);
+	else
+		jadard->vccio = devm_gpiod_get(dev, "vccio", power_flags);
+	if (IS_ERR(jadard->vccio))
+		return dev_err_probe(dev, PTR_ERR(jadard->vccio),
+				     "failed to get vccio GPIO\n");
+
+	/* DBG pin is used for osciloscope debugging, optional */
+	jadard->dbg = devm_gpiod_get_optional(dev, "dbg", GPIOD_OUT_LOW);
+	if (IS_ERR(jadard->dbg))
+		return dev_err_probe(dev, PTR_ERR(jadard->dbg),
+				     "failed to get dbg GPIO\n");
+
+	/* TE is optional, it's only wired up on some adapter boards */
+	jadard->te = devm_gpiod_get_optional(dev, "te", GPIOD_IN);
+	if (IS_ERR(jadard->te))
+		return dev_err_probe(dev, PTR_ERR(jadard->te),
+				     "failed to get te GPIO\n");
+
+	init_completion(&jadard->te_done);
+	spin_lock_init(&jadard->te_lock);
+
+	if (jadard->te) {
+		ret = devm_request_irq(dev, gpiod_to_irq(jadard->te),
+				       jadard_te_irq, IRQF_TRIGGER_RISING,
+				       "jadard-te", jadard);
+		if (ret)
+			return dev_err_probe(dev, ret, "failed to request TE IRQ\n");
 	}
 
 	drm_panel_init(&jadard->panel, dev, &jadard_funcs,
@@ -428,21 +2229,128 @@ static int jadard_dsi_probe(struct mipi_dsi_device *dsi)
 	if (ret < 0)
 		return dev_err_probe(dev, ret, "failed to get orientation\n");
 
+	/* Scan upside down mounted panels in reverse and report them upright */
+	if (desc->scan_flip &&
+	    jadard->orientation == DRM_MODE_PANEL_ORIENTATION_BOTTOM_UP) {
+		jadard->flip = true;
+		jadard->orientation = DRM_MODE_PANEL_ORIENTATION_NORMAL;
+	}
+
 	ret = drm_panel_of_backlight(&jadard->panel);
 	if (ret)
-		return ret;
-
-	drm_panel_add(&jadard->panel);
+		return dev_err_probe(dev, ret, "failed to get backlight\n");
 
 	mipi_dsi_set_drvdata(dsi, jadard);
 	jadard->dsi = dsi;
 	jadard->desc = desc;
+	jadard->timings = desc->timings;
+
+	/* The regulator core already waits for the ramp to complete */
+	if (jadard->use_supplies)
+		jadard->timings.vcioo_to_lp11_us = 0;
+
+	/* Sysfs goes live with the backlight, the locks must be ready */
+	ret = devm_mutex_init(dev, &jadard->stats_lock);
+	if (ret)
+		return ret;
+
+	ret = devm_mutex_init(dev, &jadard->reg_lock);
+	if (ret)
+		return ret;
+
+	ret = jadard_dcs_backlight_register(jadard);
+	if (ret)
+		return ret;
+
+	/* Rail ramp time depends on the regulators fitted on the board */
+	of_property_read_u32(dev->of_node, "jadard,rail-ramp-us",
+			     &jadard->timings.vcioo_to_lp11_us);
+
+	INIT_WORK(&jadard->power_up_work, jadard_power_up_work);
+	INIT_DELAYED_WORK(&jadard->esd_work, jadard_esd_work);
+
+	/* Poll the panel health while it's displaying, off unless set */
+	of_property_read_u32(dev->of_node, "jadard,esd-check-ms",
+			     &jadard->esd_interval_ms);
+
+	ret = devm_add_action_or_reset(dev, jadard_release_colour, jadard);
+	if (ret)
+		return ret;
+
+	ret = jadard_load_init_table(jadard);
+	if (ret)
+		return ret;
+
+	jadard->cur_page = -1;
+	ret = jadard_shadow_init(jadard);
+	if (ret)
+		return ret;
+
+	if (handover) {
+		/*
+		 * The rails are still up from the bootloader. Our reference on
+		 * them is only taken once attached, so a deferred probe leaves
+		 * a live panel as it found it.
+		 */
+		jadard->handover = jadard_panel_is_live(jadard);
+
+		/* Runtime PM refuses an active child of a suspended parent */
+		if (jadard->handover) {
+			ret = pm_runtime_set_active(dev);
+			if (ret) {
+				dev_warn(dev, "can't take over panel (%d), starting it cold\n",
+					 ret);
+				jadard->handover = false;
+			}
+		}
+
+		if (jadard->handover) {
+			dev_info(dev, "taking over panel from bootloader\n");
+			jadard->initialized = true;
+			jadard->asleep = false;
+			pm_runtime_get_noresume(dev);
+		} else {
+			/* Left to the first power up, a deferral costs nothing */
+			jadard->stale_rails = true;
+		}
+	}
+	live = jadard->handover;
+
+	pm_runtime_set_autosuspend_delay(dev, JADARD_AUTOSUSPEND_DELAY_MS);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+
+	drm_panel_add(&jadard->panel);
 
 	ret = mipi_dsi_attach(dsi);
-	if (ret < 0)
+	if (ret < 0) {
 		drm_panel_remove(&jadard->panel);
+		pm_runtime_dont_use_autosuspend(dev);
+		if (live) {
+			/* Keep the panel lit for the next probe to take over */
+			pm_runtime_disable(dev);
+			pm_runtime_set_suspended(dev);
+			pm_runtime_put_noidle(dev);
+		} else {
+			pm_runtime_force_suspend(dev);
+		}
+		return dev_err_probe(dev, ret, "failed to attach to DSI host\n");
+	}
 
-	return ret;
+	if (live) {
+		ret = jadard_supplies_on(jadard);
+		if (ret)
+			dev_warn(dev, "failed to enable supplies: %d\n", ret);
+	}
+
+	/*
+	 * The host binds the rest of the display pipeline from its attach
+	 * callback, ramp the panel up meanwhile. Doing it only now keeps a
+	 * deferred attach from costing a power cycle.
+	 */
+	jadard_power_up_async(jadard);
+
+	return 0;
 }
 
 static void jadard_dsi_remove(struct mipi_dsi_device *dsi)
@@ -451,8 +2359,67 @@ static void jadard_dsi_remove(struct mipi_dsi_device *dsi)
 
 	mipi_dsi_detach(dsi);
 	drm_panel_remove(&jadard->panel);
+	cancel_work_sync(&jadard->power_up_work);
+	cancel_delayed_work_sync(&jadard->esd_work);
+
+	/* Drop the rails if autosuspend hasn't done so yet */
+	pm_runtime_dont_use_autosuspend(&dsi->dev);
+	pm_runtime_force_suspend(&dsi->dev);
+}
+
+/*
+ * Nothing calls unprepare on reboot, so a displaying panel would only see its
+ * rails drop. Put it to sleep first, while the DSI host is still up, so it
+ * discharges with the display off. Power off keeps its full waits, the panel
+ * needs them.
+ */
+static void jadard_dsi_shutdown(struct mipi_dsi_device *dsi)
+{
+	struct jadard *jadard = mipi_dsi_get_drvdata(dsi);
+
+	cancel_work_sync(&jadard->power_up_work);
+	cancel_delayed_work_sync(&jadard->esd_work);
+
+	mutex_lock(&jadard->reg_lock);
+	/* Only a prepared panel is awake, anything else gets no DCS traffic */
+	if (jadard->initialized && pm_runtime_get_if_in_use(&dsi->dev) > 0) {
+		jadard_enter_sleep(jadard);
+		pm_runtime_put_noidle(&dsi->dev);
+	}
+	jadard->shutdown = true;
+	mutex_unlock(&jadard->reg_lock);
+
+	pm_runtime_force_suspend(&dsi->dev);
+}
+
+static int jadard_suspend(struct device *dev)
+{
+	struct jadard *jadard = dev_get_drvdata(dev);
+
+	cancel_work_sync(&jadard->power_up_work);
+
+	return pm_runtime_force_suspend(dev);
+}
+
+static int jadard_resume(struct device *dev)
+{
+	struct jadard *jadard = dev_get_drvdata(dev);
+	int ret;
+
+	ret = pm_runtime_force_resume(dev);
+	if (ret)
+		return ret;
+
+	jadard_power_up_async(jadard);
+
+	return 0;
 }
 
+static const struct dev_pm_ops jadard_pm_ops = {
+	SYSTEM_SLEEP_PM_OPS(jadard_suspend, jadard_resume)
+	RUNTIME_PM_OPS(jadard_runtime_suspend, jadard_runtime_resume, NULL)
+};
+
 static const struct of_device_id jadard_of_match[] = {
 	{
 		.compatible = "shenzen,z34014p30365ty1",
@@ -465,13 +2432,21 @@ MODULE_DEVICE_TABLE(of, jadard_of_match);
 static struct mipi_dsi_driver jadard_driver = {
 	.probe = jadard_dsi_probe,
 	.remove = jadard_dsi_remove,
+	.shutdown = jadard_dsi_shutdown,
 	.driver = {
 		.name = "jadard-jd9365tn",
 		.of_match_table = jadard_of_match,
+		.pm = &jadard_pm_ops,
+		.dev_groups = jadard_groups,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 };
 module_mipi_dsi_driver(jadard_driver);
 
 MODULE_AUTHOR("Kirill Yatsenko <kiriyatsenko@gmail.com>");
-MODULE_DESCRIPTION("Jadard JD9365TN WXGA DSI panel");
+MODULE_DESCRIPTION("Jadard JD9365 family DSI panels");
 MODULE_LICENSE("GPL");
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_JADARD_JD9365TN_KUNIT_TEST)
+#include "panel-jadard-jd9365tn-test.c"
+#endif
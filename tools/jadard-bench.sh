@@ -0,0 +1,132 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Blank/unblank latency benchmark for the jadard-jd9365tn panel driver.
+#
+# Cycles the fbdev emulation blank state and reads the jadard_phase_end
+# tracepoints back, then prints per phase latency distributions:
+#
+#	cold	rails dropped between cycles (autosuspend_delay_ms = 0)
+#	warm	rails kept up, only sleep out/display on (autosuspend off)
+#	boot	with -p, events from a saved trace, e.g. one captured with
+#		trace_event=jadard:* on the kernel command line
+#
+# Load the module with dbg_phase_pulses=1 to see the same phase edges on
+# the dbg GPIO with a logic analyser.
+#
+# Usage: jadard-bench.sh [-n cycles] [-f fb] [-m cold|warm|both] [-p trace]
+
+set -e
+
+cycles=20
+fb=fb0
+modes="cold warm"
+parse=
+
+while getopts "n:f:m:p:h" opt; do
+	case $opt in
+	n) cycles=$OPTARG ;;
+	f) fb=$OPTARG ;;
+	m) [ "$OPTARG" = both ] && modes="cold warm" || modes=$OPTARG ;;
+	p) parse=$OPTARG ;;
+	*) sed -n 's/^# \{0,1\}//;/^Usage/p' "$0"; exit 1 ;;
+	esac
+done
+
+# Turns "<mode> <phase> <us>" lines into one line per mode and phase
+report() {
+	sort -k1,1 -k2,2 -k3,3n | awk '
+	function flush() {
+		if (!n)
+			return
+		printf "%-6s %-12s %6d %10d %10d %10d %10d %10d\n", key[1],
+		       key[2], n, v[1], v[int((n + 1) / 2)],
+		       v[int((n * 95 + 99) / 100)], v[n], sum / n
+	}
+	BEGIN {
+		printf "%-6s %-12s %6s %10s %10s %10s %10s %10s\n", "mode",
+		       "phase", "count", "min_us", "p50_us", "p95_us",
+		       "max_us", "avg_us"
+	}
+	$1 " " $2 != cur {
+		flush()
+		cur = $1 " " $2
+		split(cur, key, " ")
+		n = 0
+		sum = 0
+	}
+	{
+		v[++n] = $3
+		sum += $3
+	}
+	END { flush() }'
+}
+
+# Extracts "<mode> <phase> <us>" from a trace, mode set by bench markers
+extract() {
+	awk -v mode="$1" '
+	/jadard-bench mode=/ {
+		sub(/.*jadard-bench mode=/, "")
+		mode = $1
+		next
+	}
+	/jadard_phase_end:/ {
+		for (i = 1; i <= NF; i++)
+			if ($i == "took")
+				print mode, $(i - 1), $(i + 1)
+	}'
+}
+
+if [ -n "$parse" ]; then
+	extract boot < "$parse" | report
+	exit 0
+fi
+
+tracefs=/sys/kernel/tracing
+[ -d $tracefs/events ] || tracefs=/sys/kernel/debug/tracing
+[ -d $tracefs/events/jadard ] || {
+	echo "jadard tracepoints not found, is the module loaded?" >&2
+	exit 1
+}
+
+panel=$(ls -d /sys/bus/mipi-dsi/drivers/jadard-jd9365tn/*/ 2>/dev/null |
+	head -n 1)
+[ -n "$panel" ] || {
+	echo "no panel bound to jadard-jd9365tn" >&2
+	exit 1
+}
+
+blank=/sys/class/graphics/$fb/blank
+delay=$(cat "$panel/power/autosuspend_delay_ms")
+
+cleanup() {
+	echo 0 > "$blank"
+	echo "$delay" > "$panel/power/autosuspend_delay_ms"
+	echo 0 > $tracefs/events/jadard/enable
+}
+trap cleanup EXIT
+
+echo > $tracefs/trace
+echo 1 > $tracefs/events/jadard/enable
+
+for mode in $modes; do
+	case $mode in
+	cold) echo 0 > "$panel/power/autosuspend_delay_ms" ;;
+	warm) echo -1 > "$panel/power/autosuspend_delay_ms" ;;
+	*) echo "unknown mode $mode" >&2; exit 1 ;;
+	esac
+
+	echo "jadard-bench mode=$mode" > $tracefs/trace_marker
+
+	i=0
+	while [ $i -lt "$cycles" ]; do
+		echo 1 > "$blank"
+		# Leave autosuspend time to run
+		sleep 0.5
+		echo 0 > "$blank"
+		sleep 0.5
+		i=$((i + 1))
+	done
+done
+
+extract none < $tracefs/trace | report